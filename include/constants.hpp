@@ -3,3 +3,23 @@
 #define MAX_SPEED_X 10.0f // Maximum speed in the X direction
 #define MAX_SPEED_Y 10.0f // Maximum speed in the Y direction
 #define MAX_SPEED_Z 10.0f // Maximum speed in the Z direction
+
+#define GRID_CELL_SIZE 4.0 // Side of a broadphase grid cell, in world units
+
+#define CACHE_LINE_SIZE 64 // Alignment keeping atomics apart from each other
+
+#define PEER_RECV_QUEUE_SIZE 256    // Messages received, not yet handled
+#define PEER_CONTROL_QUEUE_SIZE 256 // Replies and events, not yet sent
+
+#define SERVER_IO_THREADS 2 // Threads running the networking, for all peers
+#define PEER_READ_BUFFER_SIZE (16 * 1024) // Initial receive buffer of a peer
+#define PEER_MAX_FRAME_SIZE (64 * 1024)   // Larger messages disconnect a peer
+
+#define WORLD_MAX_CATCHUP_TICKS 5 // Ticks run at once by a late world
+
+#define TASK_STATS_INTERVAL 10 // Seconds between two task latency reports
+
+// Player data updates between two keyframes, for the clients taking deltas
+#define PLAYER_DATA_KEYFRAME_INTERVAL 32
+
+#define EXECUTOR_ARENA_SIZE (256 * 1024) // Kept for the messages of a phase
@@ -1,63 +1,154 @@
 #ifndef EXECUTOR_EXECUTOR_HPP
 #define EXECUTOR_EXECUTOR_HPP
 
+#include "constants.hpp"
+#include "executor/player_data_delta.hpp"
+#include "executor/radar_cache.hpp"
+#include "server/encoded_frame.hpp"
 #include "server/peer.hpp"
-#include "server/server.hpp"
+#include "server/peer_group.hpp"
 #include "visualizer/visualizer.hpp"
 #include "world/pawn.hpp"
+#include "world/tick_listener.hpp"
 #include "world/world.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <google/protobuf/arena.h>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <spdlog/spdlog.h>
+#include <utility>
+#include <vector>
 
-class Executor : public std::enable_shared_from_this<Executor> {
+/*! \brief Runs the game on top of the world, driven by its ticks: inputs
+ * are ingested before each step, then shots are resolved against the new
+ * snapshot and the players' data is sent at the output rate.
+ */
+class Executor : public World::TickListener,
+                 public std::enable_shared_from_this<Executor> {
 private:
-  std::shared_ptr<Server> server_;
+  // Peers playing on the world
+  std::shared_ptr<PeerGroup> peers_;
   std::shared_ptr<World::World> world_;
   std::shared_ptr<Visualizer> visualizer_;
+  // Shared with the previous rounds on the same world
+  std::shared_ptr<RadarCache> radar_cache_;
   std::map<std::shared_ptr<Peer>, std::shared_ptr<World::Pawn>> peer_to_pawns_;
+  std::map<std::shared_ptr<Peer>, PlayerDataDelta> player_data_streams_;
+  // Messages drained from a peer, reused from one peer to the next
+  std::vector<ClientServerMessage> inbox_;
+  // Shots received since the last tick, resolved after it
+  std::vector<std::pair<std::shared_ptr<Peer>, ClientServerMessage>>
+      pending_shots_;
+  // Ticks between two player data updates
+  uint64_t output_interval_;
+
+  // Outbound messages are built on the arena, serialized as soon as they
+  // are queued, and the arena is reset at the end of each phase. Its first
+  // block is kept, so a phase usually allocates nothing
+  std::vector<char> arena_block_;
+  google::protobuf::Arena arena_;
+
+  // Messages identical for every peer, encoded on first use
+  SharedFrame game_started_frame_;
+  SharedFrame world_options_frame_;
+
+  static google::protobuf::ArenaOptions
+  MakeArenaOptions(std::vector<char> &block) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block.data();
+    options.initial_block_size = block.size();
+    return options;
+  }
+
+  std::mutex game_m_;
+  std::condition_variable game_cv_;
+  bool game_over_ = false;
 
   void ProcessPeer(const std::shared_ptr<Peer> &peer);
 
+  /**
+   * Forget the dead peers, and remove their pawns from the world
+   */
+  void ReapPeers();
+
+  /**
+   * Create an empty message on the arena, valid until the end of the phase
+   */
+  ServerClientMessage *NewMessage();
+
   void SendPlayerData(const std::shared_ptr<Peer> &peer,
                       const std::shared_ptr<World::Pawn> &pawn);
+
   void HandleWorldInfoRequest(const std::shared_ptr<Peer> &peer);
   void HandleSetSpeed(const std::shared_ptr<Peer> &peer,
                       const ClientServerMessage &message,
                       const std::shared_ptr<World::Pawn> &pawn);
-  void HandleRadarPing(const std::shared_ptr<Peer> &peer);
+  void HandleRadarPing(const std::shared_ptr<Peer> &peer,
+                       const std::shared_ptr<World::Pawn> &pawn);
   void HandleShoot(const std::shared_ptr<Peer> &peer,
                    const ClientServerMessage &message);
 
+  /**
+   * Start being driven by the world, and woken up by the peers' messages
+   */
+  void Attach();
+
+  /**
+   * Stop being driven by the world. No tick callback runs once it returns,
+   * and the shots still waiting for a tick are rejected
+   */
+  void Detach();
+
 public:
-  Executor(std::shared_ptr<Server> server, std::shared_ptr<World::World> world,
-           std::shared_ptr<Visualizer> visualizer)
-      : server_(std::move(server)), world_(std::move(world)),
-        visualizer_(std::move(visualizer)) {}
+  /**
+   * \param output_rate player data updates sent per second, at most one per
+   * tick
+   */
+  Executor(std::shared_ptr<PeerGroup> peers,
+           std::shared_ptr<World::World> world,
+           std::shared_ptr<Visualizer> visualizer, double output_rate = 30,
+           std::shared_ptr<RadarCache> radar_cache = nullptr)
+      : peers_(std::move(peers)), world_(std::move(world)),
+        visualizer_(std::move(visualizer)),
+        radar_cache_(radar_cache ? std::move(radar_cache)
+                                 : std::make_shared<RadarCache>()),
+        output_interval_(std::max<uint64_t>(
+            1, std::llround(world_->GetTickRate() / output_rate))),
+        arena_block_(EXECUTOR_ARENA_SIZE),
+        arena_(MakeArenaOptions(arena_block_)) {}
 
   ~Executor() { spdlog::info("Stopping executor"); }
 
+  /**
+   * Run the game until it ends
+   */
   void Process();
-  bool ProcessFrame();
 
   template <typename Duration> void ProcessForDuration(Duration duration) {
-    auto start_time = std::chrono::steady_clock::now();
-    auto end_time = start_time + duration;
     spdlog::info(
         "Processing world for {} seconds",
         std::chrono::duration_cast<std::chrono::duration<float>>(duration)
             .count());
-    while (std::chrono::steady_clock::now() < end_time) {
-      if (!this->ProcessFrame()) {
-        break;
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    this->Attach();
+    {
+      std::unique_lock<std::mutex> lock(this->game_m_);
+      this->game_cv_.wait_for(lock, duration,
+                              [this] { return this->game_over_; });
     }
+    this->Detach();
     spdlog::info("Processing ended");
     this->BroadcastGameEnded();
   }
 
+  void OnInput() override;
+  void OnTick(uint64_t tick) override;
+
   void BroadcastGameEnded();
 
   bool IsPeerAlive(const std::shared_ptr<Peer> &peer);
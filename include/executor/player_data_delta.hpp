@@ -0,0 +1,33 @@
+#ifndef EXECUTOR_PLAYER_DATA_DELTA_HPP
+#define EXECUTOR_PLAYER_DATA_DELTA_HPP
+
+#include "battle_c.pb.h"
+#include <cstdint>
+
+/*! \brief Player data stream of one peer that accepts deltas. Each update
+ * holds the fields changed since the last update the peer's writer took.
+ * An update still waiting to be written is replaced by the next one, which
+ * then repeats its changes, so the client never misses one.
+ */
+class PlayerDataDelta {
+private:
+  // Latest values published
+  battle_c::PlayerData last_;
+  bool has_last_ = false;
+  // Updates since the last keyframe, sent or not
+  uint64_t since_keyframe_ = 0;
+  // Fields changed since the last update taken by the writer, one bit per
+  // field, and whether that update is a keyframe
+  uint32_t untaken_ = 0;
+
+public:
+  /**
+   * Strip pd, holding every field, down to what the client lacks.
+   * pending tells whether the previous update is still waiting to be
+   * written, and will be replaced by this one.
+   * Returns false if there is nothing new to send
+   */
+  bool Strip(battle_c::PlayerData &pd, bool pending);
+};
+
+#endif // EXECUTOR_PLAYER_DATA_DELTA_HPP
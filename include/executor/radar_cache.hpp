@@ -0,0 +1,79 @@
+#ifndef EXECUTOR_RADAR_CACHE_HPP
+#define EXECUTOR_RADAR_CACHE_HPP
+
+#include "battle_c.pb.h"
+#include "server/encoded_frame.hpp"
+#include "world/object_state.hpp"
+#include "world/static_geometry.hpp"
+#include "world/world_snapshot.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*! \brief Radar results of the latest world snapshot, encoded once however
+ * many peers ping during the tick.
+ * A RadarResult is only a list of RadarReturn fields, so its encoding is the
+ * concatenation of the encoded returns. The returns of the static geometry
+ * are encoded once per world, as long as the cache is kept from one round to
+ * the next, and only the dynamic objects are encoded again at each tick.
+ * A result limited to a range copies the returns of the objects in range,
+ * found through the grids, without encoding them again.
+ */
+class RadarCache {
+private:
+  // Static geometry the static returns were encoded from, held so that
+  // another one can't be mistaken for it
+  std::shared_ptr<const World::StaticGeometry> static_geometry_;
+  std::string static_returns_;
+  // Return of the static object i in [offsets[i], offsets[i + 1])
+  std::vector<uint32_t> static_offsets_;
+  SharedFrame static_frame_;
+
+  // Snapshot the dynamic returns were encoded from
+  uint64_t version_ = 0;
+  bool encoded_ = false;
+  std::string dynamic_returns_;
+  // Indexed like the snapshot's objects
+  std::vector<uint32_t> dynamic_offsets_;
+  SharedFrame frame_;
+  SharedFrame dynamic_frame_;
+
+  battle_c::RadarReturn radar_return_;
+  // Returns in range, reused from one ping to the next
+  std::string selected_;
+
+  /**
+   * Append the radar_return field of a RadarResult for an object, unless
+   * the radar can't see it
+   */
+  void AppendReturn(const World::ObjectState &state, std::string &returns);
+
+  /**
+   * Encode the returns of the snapshot, unless they already are
+   */
+  void Update(const World::WorldSnapshot &snapshot);
+
+public:
+  /**
+   * Frame of the ServerClientMessage holding the radar result of a snapshot
+   * \param include_static false to leave the static geometry out
+   */
+  SharedFrame Get(const World::WorldSnapshot &snapshot,
+                  bool include_static = true);
+
+  /**
+   * Frame of the radar result of the static geometry only, which never
+   * changes during a game
+   */
+  SharedFrame GetStatic(const World::WorldSnapshot &snapshot);
+
+  /**
+   * Encode the radar result of the objects overlapping the circle
+   * (x, y, range) into frame
+   */
+  void GetInRange(const World::WorldSnapshot &snapshot, double x, double y,
+                  double range, bool include_static, EncodedFrame &frame);
+};
+
+#endif // EXECUTOR_RADAR_CACHE_HPP
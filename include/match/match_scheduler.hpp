@@ -0,0 +1,73 @@
+#ifndef MATCH_MATCH_SCHEDULER_HPP
+#define MATCH_MATCH_SCHEDULER_HPP
+
+#include "round/round_manager.hpp"
+#include "server/peer_group.hpp"
+#include "server/server.hpp"
+#include "visualizer/visualizer.hpp"
+#include "world/world.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct MatchSettings {
+  // Players of a match, 0 for no limit
+  size_t players_per_match_ = 0;
+  // Player data updates sent per second, in every match
+  double output_rate_ = 30;
+};
+
+/*! \brief Hosts independent matches in one process. Each match plays its
+ * rounds on its own world, whose ticks run as tasks of the shared task
+ * scheduler, so the matches spread over its workers. Every new peer joins
+ * the match with the fewest players, and stays in it.
+ */
+class MatchScheduler {
+private:
+  struct Match {
+    std::shared_ptr<PeerGroup> peers_;
+    std::unique_ptr<RoundManager> rounds_;
+    std::thread thread_;
+  };
+
+  std::shared_ptr<Server> server_;
+  MatchSettings match_settings_;
+
+  // Guards the placement of the peers
+  std::mutex matches_m_;
+  std::vector<std::unique_ptr<Match>> matches_;
+
+  /**
+   * Add a new peer to a match with room left, or disconnect it
+   */
+  void Place(const std::shared_ptr<Peer> &peer);
+
+public:
+  MatchScheduler(std::shared_ptr<Server> server,
+                 const MatchSettings &match_settings = MatchSettings())
+      : server_(std::move(server)), match_settings_(match_settings) {}
+
+  /**
+   * Add a match played on a world, before Start()
+   */
+  void AddMatch(std::shared_ptr<World::World> world,
+                std::shared_ptr<Visualizer> visualizer);
+
+  /**
+   * Place the new peers of the server into the matches, and run the round
+   * manager of every match on a thread of its own, which only waits for the
+   * end of each round while the world ticks on the task scheduler. To be
+   * called before the server starts
+   */
+  void Start();
+
+  /**
+   * Wait for the matches, which play rounds forever
+   */
+  void Wait();
+};
+
+#endif // MATCH_MATCH_SCHEDULER_HPP
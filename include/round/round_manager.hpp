@@ -0,0 +1,47 @@
+#ifndef ROUND_ROUND_MANAGER_HPP
+#define ROUND_ROUND_MANAGER_HPP
+
+#include "executor/radar_cache.hpp"
+#include "server/peer_group.hpp"
+#include "visualizer/visualizer.hpp"
+#include "world/world.hpp"
+
+#include <cstdint>
+#include <memory>
+
+/*! \brief Plays the rounds of a game one after the other on the same world.
+ * Between two rounds the world is reset in place: the static geometry, the
+ * visualizer and the connected peers are kept, and the pawns are spawned
+ * again by the next round's executor.
+ */
+class RoundManager {
+private:
+  // Players of the game, kept from one round to the next
+  std::shared_ptr<PeerGroup> peers_;
+  std::shared_ptr<World::World> world_;
+  std::shared_ptr<Visualizer> visualizer_;
+  // Kept from one round to the next, so the static geometry is encoded once
+  std::shared_ptr<RadarCache> radar_cache_ = std::make_shared<RadarCache>();
+  // Player data updates sent per second
+  double output_rate_;
+  uint64_t round_ = 0;
+
+public:
+  RoundManager(std::shared_ptr<PeerGroup> peers,
+               std::shared_ptr<World::World> world,
+               std::shared_ptr<Visualizer> visualizer, double output_rate = 30)
+      : peers_(std::move(peers)), world_(std::move(world)),
+        visualizer_(std::move(visualizer)), output_rate_(output_rate) {}
+
+  /**
+   * Play a round until it ends, then reset the world for the next one
+   */
+  void PlayRound();
+
+  /**
+   * Play rounds forever
+   */
+  void Run();
+};
+
+#endif // ROUND_ROUND_MANAGER_HPP
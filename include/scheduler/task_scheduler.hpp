@@ -0,0 +1,132 @@
+#ifndef SCHEDULER_TASK_SCHEDULER_HPP
+#define SCHEDULER_TASK_SCHEDULER_HPP
+
+#include "constants.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using Task = std::function<void()>;
+
+/**
+ * Counters of the tasks run so far, safe to read from any thread
+ */
+struct TaskStats {
+  uint64_t tasks_ = 0;
+  // Tasks run by another worker than the one they were queued to
+  uint64_t stolen_ = 0;
+  // From the time a task is due to the time it starts
+  std::chrono::nanoseconds latency_total_{0};
+  std::chrono::nanoseconds latency_max_{0};
+  std::chrono::nanoseconds run_total_{0};
+  std::chrono::nanoseconds run_max_{0};
+};
+
+/*! \brief Pool of worker threads running short tasks, shared by every world
+ * of the process, so the worlds may outnumber the cores.
+ * Each worker has its own queue, served oldest first, and steals from the
+ * others once it is empty. Tasks due later wait in a timer queue, on a
+ * thread of their own, and go to the workers when they are due.
+ */
+class TaskScheduler {
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct QueuedTask {
+    Task task_;
+    Clock::time_point ready_;
+  };
+
+  struct alignas(CACHE_LINE_SIZE) Worker {
+    std::mutex tasks_m_;
+    std::deque<QueuedTask> tasks_;
+  };
+
+  struct TimedTask {
+    Clock::time_point deadline_;
+    Task task_;
+
+    bool operator>(const TimedTask &other) const {
+      return deadline_ > other.deadline_;
+    }
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<bool> running_ = false;
+  // Spreads the tasks queued from outside the workers
+  std::atomic<size_t> next_worker_{0};
+
+  // Idle workers sleep until a task is queued. queued_ is only increased
+  // with idle_m_ held, so no wakeup is lost
+  std::mutex idle_m_;
+  std::condition_variable idle_cv_;
+  std::atomic<size_t> queued_{0};
+
+  std::mutex timers_m_;
+  std::condition_variable timers_cv_;
+  std::priority_queue<TimedTask, std::vector<TimedTask>,
+                      std::greater<TimedTask>>
+      timers_;
+  std::thread timer_thread_;
+
+  std::atomic<uint64_t> tasks_{0};
+  std::atomic<uint64_t> stolen_{0};
+  std::atomic<int64_t> latency_total_{0};
+  std::atomic<int64_t> latency_max_{0};
+  std::atomic<int64_t> run_total_{0};
+  std::atomic<int64_t> run_max_{0};
+
+  void Queue(Task task, Clock::time_point ready);
+
+  /**
+   * Pop a task from the worker's queue, or steal one from another
+   */
+  bool Pop(size_t worker, QueuedTask &task);
+
+  void RunWorker(size_t worker);
+  void RunTimers();
+  void Run(const QueuedTask &task);
+
+  /**
+   * Log the stats, every TASK_STATS_INTERVAL seconds
+   */
+  void ReportStats();
+
+public:
+  /**
+   * \param workers number of worker threads, 0 for one per core
+   */
+  explicit TaskScheduler(size_t workers = 0);
+  ~TaskScheduler() { Stop(); }
+
+  void Start();
+
+  /**
+   * Stop the workers. The tasks not run yet are dropped
+   */
+  void Stop();
+
+  /**
+   * Run a task as soon as possible, from any thread
+   */
+  void Submit(Task task);
+
+  /**
+   * Run a task once the deadline is reached, from any thread
+   */
+  void ScheduleAt(Clock::time_point deadline, Task task);
+
+  TaskStats GetStats() const;
+};
+
+#endif // SCHEDULER_TASK_SCHEDULER_HPP
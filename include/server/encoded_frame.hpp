@@ -0,0 +1,35 @@
+#ifndef SERVER_ENCODED_FRAME_HPP
+#define SERVER_ENCODED_FRAME_HPP
+
+#include "battle_c.pb.h"
+#include <memory>
+#include <string>
+
+// Message ready to be written: its size, then its serialized data
+using EncodedFrame = std::string;
+
+// Frame encoded once and queued to any number of peers, never modified
+using SharedFrame = std::shared_ptr<const EncodedFrame>;
+
+/**
+ * Frame queued to a peer, either its own or a shared one
+ */
+struct OutboundFrame {
+  EncodedFrame owned_;
+  SharedFrame shared_;
+
+  const EncodedFrame &Get() const { return shared_ ? *shared_ : owned_; }
+};
+
+/**
+ * Serialize a message into a frame, replacing its content
+ */
+void EncodeFrame(const battle_c::ServerClientMessage &message,
+                 EncodedFrame &frame);
+
+/**
+ * Serialize a message once, to be queued to many peers
+ */
+SharedFrame MakeSharedFrame(const battle_c::ServerClientMessage &message);
+
+#endif // SERVER_ENCODED_FRAME_HPP
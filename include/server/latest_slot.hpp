@@ -0,0 +1,83 @@
+#ifndef SERVER_LATEST_SLOT_HPP
+#define SERVER_LATEST_SLOT_HPP
+
+#include "server/spsc_queue.hpp"
+#include <atomic>
+#include <cstdint>
+
+/*! \brief Lock-free slot holding the latest value written by one producer
+ * thread, for one consumer thread. A value written before the previous one
+ * was taken replaces it.
+ * Triple buffering: the producer fills the back buffer and swaps it with the
+ * middle one, the consumer swaps the front buffer with the middle one when
+ * it is fresh. The buffers are reused, keeping their capacity.
+ */
+template <typename T> class LatestSlot {
+private:
+  static constexpr uint8_t INDEX_MASK = 3;
+  static constexpr uint8_t FRESH = 4;
+
+  T buffers_[3];
+  // Index of the middle buffer, with FRESH set if it was never taken
+  std::atomic<uint8_t> middle_{1};
+  // Owned by the producer
+  uint8_t back_ = 0;
+  // Owned by the consumer
+  uint8_t front_ = 2;
+
+  std::atomic<uint64_t> pushed_{0};
+  std::atomic<uint64_t> dropped_{0};
+
+public:
+  /**
+   * Buffer to fill before publishing it, from the producer's thread. Holds
+   * an older value
+   */
+  T &Back() { return buffers_[back_]; }
+
+  /**
+   * Make the back buffer the latest value, replacing the one not taken yet
+   */
+  void Publish() {
+    uint8_t previous =
+        middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+    back_ = previous & INDEX_MASK;
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+    if (previous & FRESH) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Take the latest value, from the consumer's thread.
+   * Returns nullptr if it was already taken, otherwise the value, valid
+   * until the next call
+   */
+  T *Take() {
+    if (!(middle_.load(std::memory_order_relaxed) & FRESH)) {
+      return nullptr;
+    }
+    uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = previous & INDEX_MASK;
+    return &buffers_[front_];
+  }
+
+  /**
+   * Check if the latest value was published and not taken yet. Once false,
+   * it only turns true again with the next Publish()
+   */
+  bool Pending() const {
+    return middle_.load(std::memory_order_acquire) & FRESH;
+  }
+
+  QueueStats GetStats() const {
+    QueueStats stats;
+    stats.pushed_ = pushed_.load(std::memory_order_relaxed);
+    stats.dropped_ = dropped_.load(std::memory_order_relaxed);
+    stats.overflows_ = stats.dropped_;
+    stats.capacity_ = 1;
+    return stats;
+  }
+};
+
+#endif // SERVER_LATEST_SLOT_HPP
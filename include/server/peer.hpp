@@ -3,54 +3,168 @@
 #define SERVER_PEER_HPP
 
 #include "battle_c.pb.h"
+#include "constants.hpp"
+#include "server/encoded_frame.hpp"
+#include "server/latest_slot.hpp"
+#include "server/spsc_queue.hpp"
+#include <atomic>
 #include <boost/asio.hpp>
 #include <cstdint>
-#include <optional>
-#include <queue>
-#include <thread>
+#include <functional>
+#include <memory>
+#include <vector>
 
 enum class PeerType { UNDEFINED, PAWN, SPECTATOR };
 using namespace battle_c;
 
-class Peer {
+/**
+ * Counters of the queues of a peer
+ */
+struct PeerStats {
+  QueueStats recv_;
+  QueueStats control_;
+  QueueStats telemetry_;
+
+  uint64_t messages_sent_ = 0;
+  uint64_t bytes_sent_ = 0;
+  // Send syscalls, one per batch of messages unless the socket is full
+  uint64_t write_calls_ = 0;
+};
+
+/*! \brief Connection to a client, served asynchronously by the server's io
+ * threads. The socket is bound to a strand, so the peer's handlers never run
+ * concurrently, and only them touch the socket and the buffers below.
+ */
+class Peer : public std::enable_shared_from_this<Peer> {
 private:
   boost::asio::ip::tcp::socket socket_;
-  std::thread handler_thread_;
-  PeerType peer_type_ = PeerType::PAWN;
+  std::atomic<PeerType> peer_type_ = PeerType::PAWN;
+
+  // Filled by the io threads, drained by the executor. The executor drains
+  // it every tick, a client flooding it faster is disconnected
+  SpscQueue<ClientServerMessage> recvq{PEER_RECV_QUEUE_SIZE};
+  // Filled by the executor, drained by the io threads. Replies and events
+  // can't be lost, a client not reading them is disconnected
+  SpscQueue<OutboundFrame> control_sendq{PEER_CONTROL_QUEUE_SIZE};
+  // Only the freshest player data matters, a lagging client skips the
+  // updates superseded before they could be written
+  LatestSlot<EncodedFrame> telemetry_slot_;
+
+  std::atomic<bool> dead_ = false;
+  // Set by the first Close(), on the strand. dead_ may be set before, by
+  // Disconnect()
+  bool closed_ = false;
+  // Set by the client's init message
+  std::atomic<bool> supports_delta_ = false;
+  std::atomic<bool> radar_skips_static_ = false;
+
+  // Bytes received, frames are parsed in place from read_begin_ to
+  // read_end_. Grows up to the size of the largest frame allowed
+  std::vector<uint8_t> read_buffer_;
+  size_t read_begin_ = 0;
+  size_t read_end_ = 0;
+  uint32_t max_frame_size_ = PEER_MAX_FRAME_SIZE;
+
+  // Set while a write is scheduled on the strand, so a burst of queued
+  // messages posts a single handler
+  std::atomic<bool> write_scheduled_ = false;
+  // Batch of framed messages being written, at most one at a time. The
+  // buffer is kept from one batch to the next
+  bool writing_ = false;
+  std::vector<uint8_t> write_buffer_;
+  size_t write_offset_ = 0;
+
+  std::atomic<uint64_t> messages_sent_ = 0;
+  std::atomic<uint64_t> bytes_sent_ = 0;
+  std::atomic<uint64_t> write_calls_ = 0;
+
+  // Called from the io threads whenever a message is received, swapped
+  // atomically as the peer moves from one group to another
+  std::shared_ptr<const std::function<void()>> on_message_;
+
+  /**
+   * Read whatever is available, making room in the buffer first
+   */
+  void Read();
+
+  /**
+   * Handle every complete frame of the buffer.
+   * Returns false if the peer was closed
+   */
+  bool ParseFrames();
+
+  void HandleMessage(const uint8_t *data, size_t size);
+
+  /**
+   * Queue a frame to the control queue, disconnecting the peer if it is full
+   */
+  void QueueControl(OutboundFrame frame);
 
-  void Handle();
+  /**
+   * Post WriteNext() to the strand, unless it is already scheduled
+   */
+  void ScheduleWrite();
 
-  std::queue<ClientServerMessage> recvq = {};
-  std::queue<ServerClientMessage> sendq = {};
+  /**
+   * Write every queued message at once, if no batch is being written
+   */
+  void WriteNext();
 
-  bool dead_ = false;
+  /**
+   * Write the rest of the batch, one send call at a time
+   */
+  void WriteBatch();
+
+  /**
+   * Mark the peer as dead and close its socket, once
+   */
+  void Close(const char *where, const std::string &reason);
 
 public:
   // Constructor accepting an io_context (existing behavior)
-  Peer(boost::asio::io_context &io_context) : socket_(io_context) {}
+  Peer(boost::asio::io_context &io_context)
+      : socket_(boost::asio::make_strand(io_context)) {}
 
-  // New constructor accepting a socket
-  Peer(boost::asio::ip::tcp::socket &&socket) : socket_(std::move(socket)) {}
+  // New constructor accepting a socket, bound to a strand
+  Peer(boost::asio::ip::tcp::socket &&socket,
+       uint32_t max_frame_size = PEER_MAX_FRAME_SIZE)
+      : socket_(std::move(socket)), max_frame_size_(max_frame_size) {}
 
   /**
-   * Start the peer's thread
+   * Start reading the peer's messages
    */
   void Start();
 
   /**
-   * Queue a message to send
+   * Serialize a message and queue it, from the executor's thread, then start
+   * writing it. The message may be reused or freed once it returns.
+   * Player data goes to the telemetry slot, everything else to the control
+   * queue
+   */
+  void QueueMessage(const ServerClientMessage &message);
+
+  /**
+   * Queue a frame shared with other peers, without copying it
+   */
+  void QueueFrame(const SharedFrame &frame);
+
+  /**
+   * Queue a frame encoded for this peer only
    */
-  void QueueMessage(ServerClientMessage message);
+  void QueueFrame(EncodedFrame frame);
 
   /**
-   * Pop a received message
+   * Move every received message to the back of messages, oldest first.
+   * From the executor's thread
    */
-  std::optional<ClientServerMessage> PopMessage();
+  void PopMessages(std::vector<ClientServerMessage> &messages);
 
   /**
-   * Send messages from the queue
+   * Set the function called whenever a message is received, or nullptr
    */
-  void SendQueue();
+  void SetOnMessage(std::shared_ptr<const std::function<void()>> on_message) {
+    std::atomic_store(&on_message_, std::move(on_message));
+  }
 
   /**
    * Get and set the peer type
@@ -67,7 +181,40 @@ public:
    * Check if the peer is dead
    */
   bool IsDead() const { return dead_; }
-  void SetIsDead(bool is_dead) { dead_ = is_dead; };
+
+  /**
+   * Mark the peer as dead now, and close its socket from its strand. The
+   * server drops it from its peers
+   */
+  void Disconnect(const std::string &reason);
+
+  /**
+   * Check if the client accepts player data holding the changed fields only
+   */
+  bool SupportsDelta() const { return supports_delta_; }
+
+  /**
+   * Check if the latest player data queued is still waiting to be written.
+   * From the executor's thread
+   */
+  bool HasPendingPlayerData() const { return telemetry_slot_.Pending(); }
+
+  /**
+   * Check if the client fetches the static geometry once, and wants it left
+   * out of its radar results
+   */
+  bool RadarSkipsStatic() const { return radar_skips_static_; }
+
+  PeerStats GetStats() const {
+    PeerStats stats;
+    stats.recv_ = recvq.GetStats();
+    stats.control_ = control_sendq.GetStats();
+    stats.telemetry_ = telemetry_slot_.GetStats();
+    stats.messages_sent_ = messages_sent_;
+    stats.bytes_sent_ = bytes_sent_;
+    stats.write_calls_ = write_calls_;
+    return stats;
+  }
 };
 
 #endif // SERVER_PEER_HPP
@@ -0,0 +1,50 @@
+#ifndef SERVER_PEER_GROUP_HPP
+#define SERVER_PEER_GROUP_HPP
+
+#include "server/peer.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*! \brief Set of peers served together, e.g. the players of a match. Safe
+ * to use from any thread. Its peers notify the group's function whenever
+ * they receive a message.
+ */
+class PeerGroup {
+private:
+  std::mutex peers_m_;
+  std::vector<std::shared_ptr<Peer>> peers_;
+  std::shared_ptr<const std::function<void()>> on_message_;
+
+  /**
+   * Drop the dead peers. peers_m_ must be held
+   */
+  void RemoveDead();
+
+public:
+  /**
+   * Add a peer, dropping the dead ones first
+   */
+  void Add(const std::shared_ptr<Peer> &peer);
+
+  /**
+   * Copy of the live peers. The dead ones are dropped, their memory is
+   * released once their last handler returns
+   */
+  std::vector<std::shared_ptr<Peer>> GetPeers();
+
+  /**
+   * Number of live peers
+   */
+  size_t Size();
+
+  /**
+   * Set the function called, from the io threads, whenever a peer of the
+   * group receives a message, or nullptr
+   */
+  void SetOnMessage(std::function<void()> on_message);
+};
+
+#endif // SERVER_PEER_GROUP_HPP
@@ -2,34 +2,56 @@
 #ifndef SERVER_SERVER_HPP
 #define SERVER_SERVER_HPP
 
+#include "constants.hpp"
 #include "server/peer.hpp"
 #include <boost/asio.hpp>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
+struct ServerSettings {
+  // Threads running the networking, for all peers
+  size_t io_threads_ = SERVER_IO_THREADS;
+  // Largest message accepted from a client, in bytes
+  uint32_t max_frame_size_ = PEER_MAX_FRAME_SIZE;
+};
+
+/*! \brief Accepts the clients, and runs the networking of every peer
+ * asynchronously on a fixed pool of threads, whatever the number of
+ * connections.
+ */
 class Server : public std::enable_shared_from_this<Server> {
 private:
-  void ProcessConnections();
-  void WriteToPeers();
-
-  std::vector<std::shared_ptr<Peer>> peers_;
+  /**
+   * Accept the next connection, asynchronously
+   */
+  void Accept();
 
   boost::asio::io_context io_context_;
+  // Keeps the io threads running while no operation is pending
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+      work_guard_;
   boost::asio::ip::tcp::acceptor acceptor_;
 
-  std::thread process_connections_thread_;
-  std::thread data_writer_;
+  std::vector<std::thread> io_threads_;
+  ServerSettings server_settings_;
+
+  std::function<void(const std::shared_ptr<Peer> &)> on_accept_;
 
 public:
   /**
    * Constructor
    */
-  Server() : acceptor_(io_context_) {}
+  explicit Server(const ServerSettings &server_settings = ServerSettings())
+      : work_guard_(boost::asio::make_work_guard(io_context_)),
+        acceptor_(io_context_), server_settings_(server_settings) {}
 
   /**
-   * Starts the server in a thread
+   * Starts the server on its pool of io threads
    */
   void Start(uint64_t port);
 
@@ -41,9 +63,14 @@ public:
   void Wait();
 
   /**
-   * Retrieves the list of connected peers
+   * Set the function called, from the io threads, with each new peer before
+   * it starts reading. The server keeps no reference to its peers, the
+   * function hands them to whoever serves them. To be set before Start()
    */
-  std::vector<std::shared_ptr<Peer>> &GetPeers() { return peers_; }
+  void SetOnAccept(
+      std::function<void(const std::shared_ptr<Peer> &)> on_accept) {
+    on_accept_ = std::move(on_accept);
+  }
 };
 
 #endif // SERVER_SERVER_HPP
@@ -0,0 +1,115 @@
+#ifndef SERVER_SPSC_QUEUE_HPP
+#define SERVER_SPSC_QUEUE_HPP
+
+#include "constants.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Counters of a queue, safe to read from any thread
+ */
+struct QueueStats {
+  uint64_t pushed_ = 0;
+  uint64_t dropped_ = 0;
+  // Pushes that found the queue full, and were refused
+  uint64_t overflows_ = 0;
+  size_t capacity_ = 0;
+};
+
+/*! \brief Bounded lock-free queue between one producer thread and one
+ * consumer thread. A push to a full queue is refused, its owner is expected
+ * to give up on the consumer.
+ * Each slot carries a sequence number telling whether it is free or holds an
+ * element (Vyukov's bounded queue), so each side only reads the other's
+ * index through the slot it is about to use.
+ * The head and the tail live on their own cache lines.
+ */
+template <typename T> class SpscQueue {
+private:
+  struct Slot {
+    std::atomic<size_t> sequence_;
+    T value_;
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  // Next slot to pop, advanced by the consumer only
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+  // Next slot to push, advanced by the producer only
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+
+  // Written by the producer only
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> pushed_{0};
+  std::atomic<uint64_t> overflows_{0};
+
+  static size_t RoundCapacity(size_t capacity) {
+    size_t rounded = 2;
+    while (rounded < capacity) {
+      rounded *= 2;
+    }
+    return rounded;
+  }
+
+public:
+  /**
+   * \param capacity rounded up to a power of two
+   */
+  explicit SpscQueue(size_t capacity)
+      : mask_(RoundCapacity(capacity) - 1),
+        slots_(new Slot[mask_ + 1]) {
+    for (size_t i = 0; i <= mask_; i++) {
+      slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue &operator=(const SpscQueue &) = delete;
+
+  /**
+   * Push an element, from the producer thread. Returns false if the queue is
+   * full, the element is then dropped
+   */
+  bool Push(T value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    Slot &slot = slots_[tail & mask_];
+    if (slot.sequence_.load(std::memory_order_acquire) != tail) {
+      overflows_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    slot.value_ = std::move(value);
+    slot.sequence_.store(tail + 1, std::memory_order_release);
+    tail_.store(tail + 1, std::memory_order_release);
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * Pop the oldest element, from the consumer thread. Returns false if the
+   * queue is empty
+   */
+  bool Pop(T &value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    Slot &slot = slots_[head & mask_];
+    if (slot.sequence_.load(std::memory_order_acquire) != head + 1) {
+      return false;
+    }
+    value = std::move(slot.value_);
+    // Free the slot for the push one lap ahead
+    slot.sequence_.store(head + mask_ + 1, std::memory_order_release);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  QueueStats GetStats() const {
+    QueueStats stats;
+    stats.pushed_ = pushed_.load(std::memory_order_relaxed);
+    stats.overflows_ = overflows_.load(std::memory_order_relaxed);
+    stats.capacity_ = mask_ + 1;
+    return stats;
+  }
+};
+
+#endif // SERVER_SPSC_QUEUE_HPP
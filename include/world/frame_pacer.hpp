@@ -0,0 +1,69 @@
+#ifndef WORLD_FRAME_PACER_HPP
+#define WORLD_FRAME_PACER_HPP
+
+#include "constants.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace World {
+
+/**
+ * Counters of a world's pacing, safe to read from any thread
+ */
+struct PacingStats {
+  uint64_t ticks_ = 0;
+  // Times the world woke up with ticks due, running one or more of them
+  uint64_t wakeups_ = 0;
+  // Ticks skipped by a world too late to catch up
+  uint64_t dropped_ = 0;
+  // How late each wakeup was, from the time its first tick was due
+  std::chrono::nanoseconds jitter_total_{0};
+  std::chrono::nanoseconds jitter_max_{0};
+};
+
+/*! \brief Fixed timestep of a world. The time elapsed since the last tick
+ * accumulates, and is consumed one whole step at a time, so the world keeps
+ * its tick rate on average whatever the precision of the wakeups. The
+ * deadlines are absolute, the sleeping errors never add up.
+ */
+class FramePacer {
+private:
+  using Clock = std::chrono::steady_clock;
+
+  Clock::duration frame_duration_;
+  // When the next tick is due
+  Clock::time_point deadline_;
+  uint32_t max_steps_;
+
+  std::atomic<uint64_t> ticks_{0};
+  std::atomic<uint64_t> wakeups_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<int64_t> jitter_total_{0};
+  std::atomic<int64_t> jitter_max_{0};
+
+public:
+  /**
+   * \param max_steps ticks run at once to catch up, the next ones are dropped
+   */
+  explicit FramePacer(double tick_rate,
+                      uint32_t max_steps = WORLD_MAX_CATCHUP_TICKS);
+
+  /**
+   * Start counting, the first tick is due a frame after now
+   */
+  void Start(Clock::time_point now) { deadline_ = now + frame_duration_; }
+
+  Clock::time_point GetDeadline() const { return deadline_; }
+
+  /**
+   * Consume the ticks due at now, and return how many to run
+   */
+  uint32_t Consume(Clock::time_point now);
+
+  PacingStats GetStats() const;
+};
+
+} // namespace World
+
+#endif
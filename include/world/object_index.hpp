@@ -0,0 +1,69 @@
+#ifndef WORLD_OBJECT_INDEX_HPP
+#define WORLD_OBJECT_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace World {
+
+/*! \brief Generational reference to a dynamic object of a world.
+ * The generation is bumped whenever the slot is released, so a handle to a
+ * destroyed object is detected as stale without any id comparison.
+ */
+struct ObjectHandle {
+  uint32_t slot_ = UINT32_MAX;
+  uint32_t generation_ = 0;
+
+  bool IsNull() const { return slot_ == UINT32_MAX; }
+};
+
+/*! \brief Open addressing hash index from object ids to slots.
+ * Entries are stored inline with linear probing, and erased with backward
+ * shifting, so neither lookups nor erasures ever allocate or leave
+ * tombstones behind. Id 0 marks an empty entry, and is never assigned to an
+ * object.
+ */
+class ObjectIndex {
+private:
+  struct Entry {
+    uint64_t id;
+    uint32_t value;
+  };
+
+  std::vector<Entry> entries_;
+  size_t size_ = 0;
+  size_t mask_ = 0;
+
+  size_t Home(uint64_t id) const;
+  void Grow();
+
+public:
+  static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+  /**
+   * Insert an id, or update its value if it is already indexed
+   */
+  void Insert(uint64_t id, uint32_t value);
+
+  /**
+   * Find the value of an id, or NOT_FOUND
+   */
+  uint32_t Find(uint64_t id) const;
+
+  /**
+   * Remove an id, returns false if it was not indexed
+   */
+  bool Erase(uint64_t id);
+
+  /**
+   * Remove every id, keeping the capacity
+   */
+  void Clear();
+
+  size_t Size() const { return size_; }
+};
+
+} // namespace World
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef WORLD_OBJECT_STATE_HPP
+#define WORLD_OBJECT_STATE_HPP
+
+#include "world/object_index.hpp"
+#include "world/vector3.hpp"
+#include "world/world_object.hpp"
+#include <cstdint>
+
+namespace World {
+
+/**
+ * Copy of the state of one object, as seen at the end of a tick
+ */
+struct ObjectState {
+  uint64_t id_ = 0;
+  // Null for static objects, and for destroyed objects
+  ObjectHandle handle_;
+  WorldObjectType type_ = WorldObjectType::UNKNOWN;
+  Vector3 position_;
+  Vector3 speed_;
+  double radius_ = 0;
+  uint8_t health_ = 0; // Pawns only
+  bool destroyed_ = false;
+};
+
+} // namespace World
+
+#endif
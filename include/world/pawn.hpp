@@ -36,14 +36,16 @@ public:
   void AddArmor(int armor) { armor_ += armor; }
   uint8_t GetArmor() { return armor_; };
 
-  void Tick() override;
-
-  Vector3 &GetTargetSpeed() { return target_speed_; };
+  Vector3 GetTargetSpeed();
+  void SetTargetSpeed(const Vector3 &target_speed);
 
   WorldObjectType GetWorldObjectType() override {
     return WorldObjectType::PAWN;
   }
 
+  void Attach(PhysicsStore *store, PhysicsHandle handle) override;
+  void Detach() override;
+
   /*! \brief Register a shoot in the Pawn's memory. Does not actually does the
    * shoot, as it is handled by the executor
    * \returns true if the shoot is allowed
@@ -0,0 +1,55 @@
+#ifndef WORLD_PHYSICS_KERNELS_HPP
+#define WORLD_PHYSICS_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace World {
+
+/*! \brief Hot loops of the physics tick, over contiguous component arrays.
+ * Every implementation performs the same operations in the same order, so
+ * the vectorized kernels give bit-identical results to the scalar ones.
+ */
+struct PhysicsKernels {
+  const char *name;
+
+  /*! \brief Compute next = position + speed * delta_time for count objects,
+   * and flag the ones whose next position leaves [0, size_x] x [0, size_y]
+   */
+  void (*integrate)(size_t count, const double *position_x,
+                    const double *position_y, const double *position_z,
+                    const double *speed_x, const double *speed_y,
+                    const double *speed_z, double delta_time, double size_x,
+                    double size_y, double *next_x, double *next_y,
+                    double *next_z, uint8_t *out_of_bounds);
+
+  /*! \brief Find the first circle (xs[k], ys[k], radii[k]) overlapping the
+   * circle (x, y, radius), i.e. whose center is strictly closer than the sum
+   * of the radii, compared exactly on squared distances. Circles touching or
+   * of radius 0 never overlap.
+   * \returns the index k of the first overlapping circle, or count
+   */
+  size_t (*first_overlap)(double x, double y, double radius, const double *xs,
+                          const double *ys, const double *radii, size_t count);
+};
+
+/**
+ * Scalar implementation, always available
+ */
+const PhysicsKernels &GetScalarPhysicsKernels();
+
+/**
+ * SSE2 and AVX2 implementations, or nullptr if the running CPU doesn't
+ * support them
+ */
+const PhysicsKernels *GetSSE2PhysicsKernels();
+const PhysicsKernels *GetAVX2PhysicsKernels();
+
+/**
+ * Fastest implementation supported by the running CPU, selected once
+ */
+const PhysicsKernels &GetPhysicsKernels();
+
+} // namespace World
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef WORLD_PHYSICS_STORE_HPP
+#define WORLD_PHYSICS_STORE_HPP
+
+#include "world/vector3.hpp"
+#include "world/world_object.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace World {
+
+enum PhysicsFlags : uint8_t {
+  PHYSICS_DESTROYED = 1 << 0,
+  // Speed converges toward the target speed every tick (pawns)
+  PHYSICS_STEERED = 1 << 1,
+};
+
+/*! \brief Data-oriented storage of the dynamic objects' physical state.
+ * Every component lives in its own contiguous array, indexed by the object's
+ * PhysicsHandle, so the tick can run as tight loops over plain doubles.
+ * WorldObject instances attached to the store only act as facades over it.
+ */
+class PhysicsStore {
+private:
+  std::vector<double> position_x_;
+  std::vector<double> position_y_;
+  std::vector<double> position_z_;
+  std::vector<double> speed_x_;
+  std::vector<double> speed_y_;
+  std::vector<double> speed_z_;
+  std::vector<double> target_speed_x_;
+  std::vector<double> target_speed_y_;
+  std::vector<double> target_speed_z_;
+  std::vector<double> radius_;
+  std::vector<uint8_t> flags_;
+  std::vector<WorldObjectType> type_;
+
+public:
+  /**
+   * Append an object, and return its handle
+   */
+  PhysicsHandle Add(const Vector3 &position, const Vector3 &speed,
+                    double radius, uint8_t flags, WorldObjectType type);
+
+  /**
+   * Remove an object, moving the last one into its place.
+   * Returns the former handle of the moved object, handle itself if it was
+   * the last one
+   */
+  PhysicsHandle SwapRemove(PhysicsHandle handle);
+
+  /**
+   * Remove every object, keeping the capacity
+   */
+  void Clear();
+
+  size_t Size() const { return flags_.size(); }
+
+  Vector3 GetPosition(PhysicsHandle handle) const {
+    return Vector3(position_x_[handle], position_y_[handle],
+                   position_z_[handle]);
+  }
+  void SetPosition(PhysicsHandle handle, const Vector3 &position) {
+    position_x_[handle] = position.GetX();
+    position_y_[handle] = position.GetY();
+    position_z_[handle] = position.GetZ();
+  }
+
+  Vector3 GetSpeed(PhysicsHandle handle) const {
+    return Vector3(speed_x_[handle], speed_y_[handle], speed_z_[handle]);
+  }
+  void SetSpeed(PhysicsHandle handle, const Vector3 &speed) {
+    speed_x_[handle] = speed.GetX();
+    speed_y_[handle] = speed.GetY();
+    speed_z_[handle] = speed.GetZ();
+  }
+
+  Vector3 GetTargetSpeed(PhysicsHandle handle) const {
+    return Vector3(target_speed_x_[handle], target_speed_y_[handle],
+                   target_speed_z_[handle]);
+  }
+  void SetTargetSpeed(PhysicsHandle handle, const Vector3 &target_speed) {
+    target_speed_x_[handle] = target_speed.GetX();
+    target_speed_y_[handle] = target_speed.GetY();
+    target_speed_z_[handle] = target_speed.GetZ();
+  }
+
+  double GetRadius(PhysicsHandle handle) const { return radius_[handle]; }
+  void SetRadius(PhysicsHandle handle, double radius) {
+    radius_[handle] = radius;
+  }
+
+  bool HasFlag(PhysicsHandle handle, PhysicsFlags flag) const {
+    return flags_[handle] & flag;
+  }
+  void SetFlag(PhysicsHandle handle, PhysicsFlags flag, bool value) {
+    flags_[handle] = value ? flags_[handle] | flag : flags_[handle] & ~flag;
+  }
+
+  WorldObjectType GetType(PhysicsHandle handle) const { return type_[handle]; }
+
+  // Raw component arrays, for the tick loops
+  double *PositionX() { return position_x_.data(); }
+  double *PositionY() { return position_y_.data(); }
+  double *PositionZ() { return position_z_.data(); }
+  double *SpeedX() { return speed_x_.data(); }
+  double *SpeedY() { return speed_y_.data(); }
+  double *SpeedZ() { return speed_z_.data(); }
+  const double *TargetSpeedX() const { return target_speed_x_.data(); }
+  const double *TargetSpeedY() const { return target_speed_y_.data(); }
+  const double *TargetSpeedZ() const { return target_speed_z_.data(); }
+  const double *Radius() const { return radius_.data(); }
+  const uint8_t *Flags() const { return flags_.data(); }
+};
+
+} // namespace World
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef WORLD_SPATIAL_GRID_HPP
+#define WORLD_SPATIAL_GRID_HPP
+
+#include "world/physics_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace World {
+
+/*! \brief Uniform grid broadphase covering the world bounds.
+ * Items are bucketed by their center, and queries widen their search area by
+ * the largest inserted radius so every potentially overlapping item is
+ * visited. The grid is rebuilt with Clear(), Insert() and Build(), reusing its
+ * buffers from one rebuild to the next.
+ * Build() also copies the items' circles in cell order, so the cells of a row
+ * hold their circles in contiguous arrays the physics kernels can scan.
+ */
+class SpatialGrid {
+private:
+  struct PendingItem {
+    uint32_t cell;
+    uint32_t item;
+    double x;
+    double y;
+    double radius;
+  };
+
+  double cell_size_ = 1;
+  int32_t cells_x_ = 1;
+  int32_t cells_y_ = 1;
+  double max_radius_ = 0;
+
+  // Items collected by Insert() until the next Build()
+  std::vector<PendingItem> pending_;
+
+  // Items of cell c are items_[cell_start_[c]] .. items_[cell_start_[c + 1]]
+  std::vector<uint32_t> cell_start_;
+  std::vector<uint32_t> items_;
+  std::vector<double> item_x_;
+  std::vector<double> item_y_;
+  std::vector<double> item_radius_;
+
+  int32_t CellX(double x) const;
+  int32_t CellY(double y) const;
+
+  /**
+   * Distance along the ray to the circle, false if the ray misses it
+   */
+  static bool RayCircle(double x, double y, double dir_x, double dir_y,
+                        double center_x, double center_y, double radius,
+                        double &t) {
+    double to_x = center_x - x;
+    double to_y = center_y - y;
+    double c = to_x * to_x + to_y * to_y - radius * radius;
+    if (c <= 0) {
+      // The ray starts inside the circle
+      t = 0;
+      return true;
+    }
+    double b = to_x * dir_x + to_y * dir_y;
+    double discriminant = b * b - c;
+    if (b <= 0 || discriminant < 0) {
+      return false;
+    }
+    t = b - std::sqrt(discriminant);
+    return true;
+  }
+
+public:
+  static constexpr uint32_t NO_ITEM = UINT32_MAX;
+
+  /**
+   * Resize the grid to cover [0, size_x] x [0, size_y], and clear it
+   */
+  void Reset(double size_x, double size_y, double cell_size);
+
+  void Clear();
+
+  /**
+   * Add an item. Positions outside the bounds land in the border cells
+   */
+  void Insert(uint32_t item, double x, double y, double radius);
+
+  /**
+   * Sort the inserted items into their cells. Must be called before querying
+   */
+  void Build();
+
+  /*! \brief Visit every item whose cell may hold an object overlapping the
+   * circle (x, y, range).
+   * \param fn called with each item index, returns true to stop the query
+   * \returns true if the query was stopped by fn
+   */
+  template <typename Fn>
+  bool ForEachNear(double x, double y, double range, Fn &&fn) const {
+    range += max_radius_;
+    int32_t min_x = CellX(x - range), max_x = CellX(x + range);
+    int32_t min_y = CellY(y - range), max_y = CellY(y + range);
+
+    for (int32_t cy = min_y; cy <= max_y; cy++) {
+      for (int32_t cx = min_x; cx <= max_x; cx++) {
+        uint32_t cell = cy * cells_x_ + cx;
+        for (uint32_t i = cell_start_[cell]; i < cell_start_[cell + 1]; i++) {
+          if (fn(items_[i])) {
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  /*! \brief Find an item whose circle, as inserted, overlaps the circle
+   * (x, y, radius).
+   * \param accept called with each overlapping item, returns false to keep
+   * searching (e.g. to skip the querying object itself)
+   * \returns the first accepted item, or NO_ITEM
+   */
+  template <typename Fn>
+  uint32_t FindOverlap(double x, double y, double radius, Fn &&accept) const {
+    const auto &kernels = GetPhysicsKernels();
+    double range = radius + max_radius_;
+    int32_t min_x = CellX(x - range), max_x = CellX(x + range);
+    int32_t min_y = CellY(y - range), max_y = CellY(y + range);
+
+    for (int32_t cy = min_y; cy <= max_y; cy++) {
+      // The cells min_x .. max_x of a row are contiguous
+      size_t begin = cell_start_[cy * cells_x_ + min_x];
+      size_t end = cell_start_[cy * cells_x_ + max_x + 1];
+      while (begin < end) {
+        size_t hit = begin + kernels.first_overlap(
+                                 x, y, radius, &item_x_[begin],
+                                 &item_y_[begin], &item_radius_[begin],
+                                 end - begin);
+        if (hit == end) {
+          break;
+        }
+        if (accept(items_[hit])) {
+          return items_[hit];
+        }
+        begin = hit + 1;
+      }
+    }
+    return NO_ITEM;
+  }
+
+  /*! \brief Find the nearest item whose circle, as inserted, is crossed by
+   * the ray starting at (x, y) along the unit vector (dir_x, dir_y).
+   * The rows of cells are walked in the order the ray crosses them, each one
+   * over the span of cells the ray passes within the largest radius of, and
+   * the walk stops at the first row starting beyond the nearest hit.
+   * \param distance length of the ray, set to the distance of the hit
+   * \param accept called with each item crossed closer than the nearest hit
+   * so far, returns false to ignore it (e.g. the shooter itself)
+   * \returns the nearest accepted item, or NO_ITEM
+   */
+  template <typename Fn>
+  uint32_t RayCast(double x, double y, double dir_x, double dir_y,
+                   double &distance, Fn &&accept) const {
+    const double pad = max_radius_;
+    double end_y = y + dir_y * distance;
+    int32_t first_row = CellY(std::min(y, end_y) - pad);
+    int32_t last_row = CellY(std::max(y, end_y) + pad);
+    int32_t step = 1;
+    if (dir_y < 0) {
+      std::swap(first_row, last_row);
+      step = -1;
+    }
+
+    uint32_t best = NO_ITEM;
+    for (int32_t cy = first_row;; cy += step) {
+      // Part of the ray within reach of the centers bucketed in this row,
+      // the border rows also hold the centers out of the bounds
+      double low = cy == 0 ? -INFINITY : cy * cell_size_ - pad;
+      double high = cy == cells_y_ - 1 ? INFINITY : (cy + 1) * cell_size_ + pad;
+      double t_min = 0;
+      double t_max = distance;
+      if (dir_y != 0) {
+        double t_low = (low - y) / dir_y;
+        double t_high = (high - y) / dir_y;
+        t_min = std::max(t_min, std::min(t_low, t_high));
+        t_max = std::min(t_max, std::max(t_low, t_high));
+        if (t_min > distance) {
+          // Rows are entered in order, so the next ones are even further
+          break;
+        }
+      } else if (y < low || y > high) {
+        t_max = -1;
+      }
+
+      if (t_min <= t_max) {
+        double x_min = x + dir_x * t_min;
+        double x_max = x + dir_x * t_max;
+        int32_t min_x = CellX(std::min(x_min, x_max) - pad);
+        int32_t max_x = CellX(std::max(x_min, x_max) + pad);
+        size_t begin = cell_start_[cy * cells_x_ + min_x];
+        size_t end = cell_start_[cy * cells_x_ + max_x + 1];
+        for (size_t i = begin; i < end; i++) {
+          double t;
+          if (item_radius_[i] != 0 &&
+              RayCircle(x, y, dir_x, dir_y, item_x_[i], item_y_[i],
+                        item_radius_[i], t) &&
+              t < distance && accept(items_[i])) {
+            distance = t;
+            best = items_[i];
+          }
+        }
+      }
+
+      if (cy == last_row) {
+        break;
+      }
+    }
+    return best;
+  }
+};
+
+} // namespace World
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef WORLD_STATIC_GEOMETRY_HPP
+#define WORLD_STATIC_GEOMETRY_HPP
+
+#include "world/object_index.hpp"
+#include "world/object_state.hpp"
+#include "world/spatial_grid.hpp"
+#include "world/world_object.hpp"
+#include <memory>
+#include <vector>
+
+namespace World {
+
+/*! \brief Immutable set of the objects that never move (walls, bounds),
+ * indexed once when the world is generated. Dynamic objects are swept against
+ * it, but it is never ticked nor integrated.
+ */
+class StaticGeometry {
+private:
+  std::vector<std::shared_ptr<WorldObject>> objects_;
+  // Copies of the objects' state, indexed like objects_
+  std::vector<ObjectState> states_;
+  SpatialGrid grid_;
+  ObjectIndex index_;
+
+public:
+  StaticGeometry(std::vector<std::shared_ptr<WorldObject>> objects,
+                 double size_x, double size_y);
+
+  const std::vector<std::shared_ptr<WorldObject>> &GetObjects() const {
+    return objects_;
+  }
+
+  const std::vector<ObjectState> &GetStates() const { return states_; }
+
+  /**
+   * Find a static object by id, or nullptr
+   */
+  std::shared_ptr<WorldObject> FindById(uint64_t id) const {
+    uint32_t index = index_.Find(id);
+    return index == ObjectIndex::NOT_FOUND ? nullptr : objects_[index];
+  }
+
+  /*! \brief Visit the static objects whose cell may overlap the circle
+   * (x, y, range).
+   * \param fn called with each object index, returns true to stop the query
+   * \returns true if the query was stopped by fn
+   */
+  template <typename Fn>
+  bool ForEachNear(double x, double y, double range, Fn &&fn) const {
+    return grid_.ForEachNear(x, y, range, fn);
+  }
+
+  /*! \brief Find a static object overlapping the circle (x, y, radius)
+   * \returns the object, or nullptr
+   */
+  std::shared_ptr<WorldObject> FindOverlap(double x, double y,
+                                           double radius) const {
+    uint32_t index =
+        grid_.FindOverlap(x, y, radius, [](uint32_t) { return true; });
+    return index == SpatialGrid::NO_ITEM ? nullptr : objects_[index];
+  }
+
+  /*! \brief Find the nearest static object crossed by a ray
+   * \param distance length of the ray, set to the distance of the hit
+   * \returns the state of the object, or nullptr
+   */
+  const ObjectState *RayCast(double x, double y, double dir_x, double dir_y,
+                             double &distance) const {
+    uint32_t index = grid_.RayCast(x, y, dir_x, dir_y, distance,
+                                   [](uint32_t) { return true; });
+    return index == SpatialGrid::NO_ITEM ? nullptr : &states_[index];
+  }
+};
+
+} // namespace World
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef WORLD_TICK_LISTENER_HPP
+#define WORLD_TICK_LISTENER_HPP
+
+#include <cstdint>
+
+namespace World {
+
+/*! \brief Phases driven by the world thread around each tick.
+ * Callbacks run on the world thread without the world lock held, so they
+ * may query and modify the world, but never run concurrently with a step.
+ */
+class TickListener {
+public:
+  virtual ~TickListener() = default;
+
+  /**
+   * Ingest the inputs received so far. Called before each step, and whenever
+   * the world is notified between two steps
+   */
+  virtual void OnInput() {}
+
+  /**
+   * Called after the snapshot of the tick is published
+   */
+  virtual void OnTick(uint64_t tick) {}
+};
+
+} // namespace World
+
+#endif
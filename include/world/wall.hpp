@@ -20,6 +20,8 @@ public:
   WorldObjectType GetWorldObjectType() override {
     return WorldObjectType::WALL;
   }
+
+  bool IsStatic() override { return true; }
 };
 
 } // namespace World
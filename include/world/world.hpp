@@ -1,10 +1,22 @@
 #ifndef WORLD_WORLD_HPP
 #define WORLD_WORLD_HPP
 
+#include "scheduler/task_scheduler.hpp"
+#include "world/frame_pacer.hpp"
+#include "world/object_index.hpp"
+#include "world/physics_store.hpp"
+#include "world/spatial_grid.hpp"
+#include "world/static_geometry.hpp"
+#include "world/tick_listener.hpp"
 #include "world/world_object.hpp"
+#include "world/world_snapshot.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 
 namespace World {
@@ -16,32 +28,203 @@ struct WorldSettings {
   bool autoaim_enabled_ = false;
   bool radar_enabled_ = true;
   bool max_players_ = 32;
+
+  // Simulated ticks per second
+  double tick_rate_ = 60;
+
+  // Distance the radar sees from a pawn, 0 for the whole map
+  double radar_range_ = 0;
 };
 
 class World : std::enable_shared_from_this<World> {
 private:
   std::mutex wo_m;
+  // Dynamic objects, world_objects_[handle] is attached to physics_store_
   std::vector<std::shared_ptr<WorldObject>> world_objects_;
+  PhysicsStore physics_store_;
+
+  struct ObjectSlot {
+    uint32_t dense_ = 0;
+    uint32_t generation_ = 0;
+  };
+  static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+  // Stable slots of the live dynamic objects, referenced by ObjectHandle.
+  // Ids map to slots, and slots to PhysicsHandle
+  std::vector<ObjectSlot> slots_;
+  std::vector<uint32_t> free_slots_;
+  // Slot of each dynamic object, NO_SLOT once it is destroyed
+  std::vector<uint32_t> dense_slots_;
+  ObjectIndex id_index_;
+  // Per-tick scratch buffers of the integration kernel, indexed by handle
+  std::vector<double> next_x_;
+  std::vector<double> next_y_;
+  std::vector<double> next_z_;
+  std::vector<uint8_t> out_of_bounds_;
+
+  // Static objects added so far, indexed into static_geometry_ on Start()
+  std::vector<std::shared_ptr<WorldObject>> static_objects_;
+  std::shared_ptr<const StaticGeometry> static_geometry_;
+  bool static_geometry_dirty_ = false;
+
+  // Latest published snapshot, swapped atomically at the end of each tick
+  std::shared_ptr<const WorldSnapshot> snapshot_;
+  // Snapshot buffers owned by the physics thread: the published one, and
+  // the previous one, refilled once its last reader released it
+  std::shared_ptr<WorldSnapshot> front_snapshot_;
+  std::shared_ptr<WorldSnapshot> back_snapshot_;
+  // Snapshots published, from one round to the next
+  uint64_t snapshot_version_ = 0;
+  uint64_t tick_ = 0;
+
   std::thread process_thread_;
+  SpatialGrid grid_;
   WorldSettings world_settings_;
+  FramePacer pacer_{world_settings_.tick_rate_};
 
-  bool is_running_ = false;
+  // Changed holding both tick_m_ and tasks_m_
+  std::atomic<bool> is_running_ = false;
+
+  // Wakes the world thread up before its next tick, guards listener_ and
+  // notified_
+  std::mutex tick_m_;
+  std::condition_variable tick_cv_;
+  bool notified_ = false;
+  // Held while a listener callback runs
+  std::mutex listener_m_;
+  std::shared_ptr<TickListener> listener_;
+
+  // Runs the ticks as tasks instead of process_thread_, if set
+  std::shared_ptr<TaskScheduler> scheduler_;
+  // Set while an input task is queued
+  std::atomic<bool> input_queued_ = false;
+  // Tasks queued and not done yet, Stop() waits for them. Guarded by
+  // tasks_m_, which is_running_ changes hold too, so no task begins after
+  // Stop() cleared it
+  std::mutex tasks_m_;
+  std::condition_variable tasks_cv_;
+  uint32_t tasks_in_flight_ = 0;
 
   void Process();
 
+  /**
+   * Step the world, publish it, and run the tick phase of the listener.
+   * listener_m_ must be held
+   */
+  void Tick();
+
+  /**
+   * Run the ticks due by now. listener_m_ must be held
+   */
+  void RunDueTicks();
+
+  /**
+   * Count a task queued to the scheduler, unless the world is stopped
+   */
+  bool BeginTask();
+  void EndTask();
+
+  /**
+   * Queue the next tick, due at the pacer's deadline
+   */
+  void ScheduleTick();
+  void RunTickTask();
+  void RunInputTask();
+
+  /**
+   * Advance the dynamic objects by one frame. wo_m must be held
+   */
+  void Step(double delta_time);
+
+  void BuildStaticGeometry();
+
+  /**
+   * Drop a destroyed object from the id index, and invalidate its handles
+   */
+  void ReleaseSlot(PhysicsHandle handle);
+
+  /**
+   * Remove the destroyed objects from the store and world_objects_, so the
+   * tick only walks the live ones. wo_m must be held
+   */
+  void RetireDestroyed();
+
+  /**
+   * Publish the state of the world to the readers. wo_m must be held
+   */
+  void PublishSnapshot();
+
 public:
+  World() = default;
+  explicit World(const WorldSettings &world_settings)
+      : world_settings_(world_settings) {}
+
   void AddObject(std::shared_ptr<WorldObject> wo);
 
-  std::vector<std::shared_ptr<WorldObject>> &GetWorldObjects();
+  /**
+   * Static objects (walls, bounds), indexed once the world is started
+   */
+  std::shared_ptr<const StaticGeometry> GetStaticGeometry() const;
+
+  /*! \brief Latest state of the world, safe to read from any thread.
+   * \returns the snapshot published by the last tick, or nullptr before the
+   * world is started
+   */
+  std::shared_ptr<const WorldSnapshot> GetSnapshot() const;
+
+  /*! \brief Find the nearest object crossed by a ray in the latest snapshot,
+   * in time proportional to the objects along the ray.
+   * \param direction unit vector, only its x and y are used
+   * \param ignore_id id of an object the ray goes through, e.g. the shooter
+   */
+  std::optional<RayHit> RayCast(const Vector3 &origin,
+                                const Vector3 &direction, double max_distance,
+                                uint64_t ignore_id) const;
+
+  /**
+   * Run the ticks as tasks of a scheduler shared with other worlds, instead
+   * of a thread of its own. To be set before Start()
+   */
+  void SetTaskScheduler(std::shared_ptr<TaskScheduler> scheduler) {
+    scheduler_ = std::move(scheduler);
+  }
 
   void Start();
 
   void Stop();
 
+  /*! \brief Remove every dynamic object, for a new round. The static
+   * geometry stays indexed, and the buffers keep their capacity. The world
+   * must be stopped.
+   */
+  void Reset();
+
+  /**
+   * Set the listener driven by the ticks, or nullptr. Once it returns, the
+   * previous listener is no longer called
+   */
+  void SetTickListener(std::shared_ptr<TickListener> listener);
+
+  /**
+   * Run the input phase of the listener as soon as possible, without waiting
+   * for the next tick
+   */
+  void Notify();
+
   double GetSizeX() { return world_settings_.sizeX_; };
   double GetSizeY() { return world_settings_.sizeY_; };
+  double GetTickRate() { return world_settings_.tick_rate_; };
+  double GetRadarRange() { return world_settings_.radar_range_; };
 
+  /**
+   * Find a live object by id, in constant time
+   */
   std::shared_ptr<WorldObject> GetWorldObjectById(uint64_t id);
+
+  /**
+   * Resolve a handle, or nullptr if the object was destroyed since
+   */
+  std::shared_ptr<WorldObject> GetWorldObject(ObjectHandle handle);
   void GenerateRandomWalls(int num_walls, int wall_radius);
   void GenWallBounds();
   void GenerateRandomBoosts(int num_boosts);
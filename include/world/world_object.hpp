@@ -3,6 +3,7 @@
 
 #include "vector3.hpp"
 #include <cstdint>
+#include <memory>
 #include <spdlog/spdlog.h>
 #include <sys/types.h>
 
@@ -10,37 +11,75 @@ namespace World {
 
 enum class WorldObjectType { PAWN, WALL, BOOST, UNKNOWN };
 
+class PhysicsStore;
+
+/**
+ * Index of a dynamic object in its world's PhysicsStore
+ */
+using PhysicsHandle = uint32_t;
+
 class WorldObject {
   uint64_t id_;
+
+  // Physical state of the object while it is not attached to a PhysicsStore.
+  // Static objects are never attached, and always use it.
   Vector3 position_ = Vector3(0.0f, 0.0f, 0.0f);
   Vector3 speed_ = Vector3(0.0f, 0.0f, 0.0f);
-  Vector3 acceleration_ = Vector3(0.0f, 0.0f, 0.0f);
 
   uint64_t radius_ = 1;
 
   bool destroyed_ = false;
 
+protected:
+  PhysicsStore *store_ = nullptr;
+  PhysicsHandle handle_ = 0;
+
 public:
   WorldObject();
   virtual ~WorldObject() { spdlog::trace("Destroyed WO {}", this->GetId()); };
-  virtual void Tick() {};
 
   uint64_t GetId() { return id_; }
-  Vector3 &GetPosition() { return position_; }
-  Vector3 &GetSpeed() { return speed_; }
-  Vector3 &GetAcceleration() { return acceleration_; }
-  uint64_t GetRadius() { return radius_; }
-  void SetRadius(uint64_t radius) { radius_ = radius; }
+
+  Vector3 GetPosition();
+  void SetPosition(const Vector3 &position);
+
+  Vector3 GetSpeed();
+  void SetSpeed(const Vector3 &speed);
+
+  uint64_t GetRadius();
+  void SetRadius(uint64_t radius);
 
   virtual void HandleCollision(std::shared_ptr<WorldObject> other);
 
-  bool IsDestroyed() { return destroyed_; }
+  bool IsDestroyed();
 
-  void SetIsDestroyed(bool destroyed) { destroyed_ = destroyed; }
+  void SetIsDestroyed(bool destroyed);
 
   virtual WorldObjectType GetWorldObjectType() {
     return WorldObjectType::UNKNOWN;
   }
+
+  /**
+   * Static objects never move, and are indexed once by the world
+   */
+  virtual bool IsStatic() { return false; }
+
+  /*! \brief Move the object's physical state into a world's store. From now
+   * on, the accessors read and write the store.
+   */
+  virtual void Attach(PhysicsStore *store, PhysicsHandle handle);
+
+  /*! \brief Move the object's physical state out of its store, when the
+   * world retires it. The accessors keep working on the last state.
+   */
+  virtual void Detach();
+
+  /**
+   * Follow the object's state, moved to another handle of the same store
+   */
+  void SetPhysicsHandle(PhysicsHandle handle) { handle_ = handle; }
+
+  PhysicsHandle GetPhysicsHandle() { return handle_; }
 };
 } // namespace World
 #endif
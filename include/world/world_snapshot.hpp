@@ -0,0 +1,64 @@
+#ifndef WORLD_WORLD_SNAPSHOT_HPP
+#define WORLD_WORLD_SNAPSHOT_HPP
+
+#include "world/object_state.hpp"
+#include "world/spatial_grid.hpp"
+#include "world/static_geometry.hpp"
+#include "world/vector3.hpp"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace World {
+
+/**
+ * Object crossed by a ray, and its distance from the origin of the ray
+ */
+struct RayHit {
+  ObjectState state_;
+  double distance_ = 0;
+};
+
+/*! \brief Immutable picture of the world published by the physics thread at
+ * the end of every tick. Readers hold it through a shared_ptr, and never see
+ * a half-updated frame nor block the physics thread.
+ */
+struct WorldSnapshot {
+  // Unique among the snapshots of a world, across its rounds
+  uint64_t version_ = 0;
+
+  std::shared_ptr<const StaticGeometry> static_geometry_;
+
+  // Dynamic objects, including the destroyed ones
+  std::vector<ObjectState> objects_;
+
+  // Live dynamic objects, by index into objects_
+  SpatialGrid grid_;
+
+  /**
+   * Visit the static objects, then the dynamic ones
+   */
+  template <typename Fn> void ForEachObject(Fn &&fn) const {
+    if (static_geometry_) {
+      for (const auto &state : static_geometry_->GetStates()) {
+        fn(state);
+      }
+    }
+    for (const auto &state : objects_) {
+      fn(state);
+    }
+  }
+
+  /*! \brief Find the nearest live object crossed by a ray, static or not
+   * \param direction unit vector, only its x and y are used
+   * \param ignore_id id of an object the ray goes through, e.g. the shooter
+   */
+  std::optional<RayHit> RayCast(const Vector3 &origin,
+                                const Vector3 &direction, double max_distance,
+                                uint64_t ignore_id) const;
+};
+
+} // namespace World
+
+#endif
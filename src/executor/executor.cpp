@@ -9,42 +9,112 @@
 #include <exception>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <spdlog/spdlog.h>
 #include <thread>
 
 void Executor::Process() {
   std::cout << "Executor, processing" << std::endl;
-  while (true) {
-    if (!this->ProcessFrame()) {
-      break;
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  this->Attach();
+  {
+    std::unique_lock<std::mutex> lock(this->game_m_);
+    this->game_cv_.wait(lock, [this] { return this->game_over_; });
   }
+  this->Detach();
   this->BroadcastGameEnded();
 }
 
-bool Executor::ProcessFrame() {
-  uint64_t alive_pawns = 0;
-  uint64_t total_pawns = 0;
-  for (const auto &peer : server_->GetPeers()) {
+void Executor::Attach() {
+  this->peers_->SetOnMessage([world = this->world_] { world->Notify(); });
+  this->world_->SetTickListener(shared_from_this());
+}
+
+void Executor::Detach() {
+  this->world_->SetTickListener(nullptr);
+  this->peers_->SetOnMessage(nullptr);
+
+  // No tick will resolve them, their clients still get a reply
+  if (!this->pending_shots_.empty()) {
+    auto *message = this->NewMessage();
+    ShootResult *shoot_result = message->mutable_shoot_result();
+    shoot_result->set_success(false);
+    shoot_result->set_fail_reason(ShootFailReason::GAME_OVER);
+    SharedFrame frame = MakeSharedFrame(*message);
+    for (const auto &[peer, shot] : this->pending_shots_) {
+      peer->QueueFrame(frame);
+    }
+    this->pending_shots_.clear();
+    this->arena_.Reset();
+  }
+}
+
+void Executor::OnInput() {
+  for (const auto &peer : peers_->GetPeers()) {
     if (peer->GetPeerType() == PeerType::PAWN && !peer->IsDead()) {
       try {
         ProcessPeer(peer);
       } catch (std::exception e) {
-        peer->SetIsDead(true);
+        peer->Disconnect(e.what());
+      }
+    }
+  }
+  // Every message of the phase is serialized by now
+  this->arena_.Reset();
+}
+
+void Executor::OnTick(uint64_t tick) {
+  // Shots see the world as of the end of this tick
+  for (const auto &[peer, message] : this->pending_shots_) {
+    HandleShoot(peer, message);
+  }
+  this->pending_shots_.clear();
+
+  bool send_player_data = tick % this->output_interval_ == 0;
+  uint64_t alive_pawns = 0;
+  uint64_t total_pawns = 0;
+  for (const auto &peer : peers_->GetPeers()) {
+    if (peer->GetPeerType() == PeerType::PAWN && !peer->IsDead()) {
+      auto &pawn = peer_to_pawns_[peer];
+      if (pawn && send_player_data) {
+        SendPlayerData(peer, pawn);
       }
       total_pawns++;
       alive_pawns += this->IsPeerAlive(peer) ? 1 : 0;
     }
   }
+  this->arena_.Reset();
+  this->ReapPeers();
+
   if (total_pawns >= 2 && alive_pawns == 1) {
     spdlog::info("Game has ended ! All but 1 pawns are dead");
-    return false;
+    {
+      std::lock_guard<std::mutex> lock(this->game_m_);
+      this->game_over_ = true;
+    }
+    this->game_cv_.notify_all();
   }
+}
 
-  return true;
+void Executor::ReapPeers() {
+  for (auto it = this->peer_to_pawns_.begin();
+       it != this->peer_to_pawns_.end();) {
+    const auto &[peer, pawn] = *it;
+    if (!peer->IsDead()) {
+      ++it;
+      continue;
+    }
+    if (pawn && !pawn->IsDestroyed()) {
+      // The pawn leaves with its player, the world retires it
+      spdlog::info("Removing the pawn {} of a disconnected peer",
+                   pawn->GetId());
+      pawn->SetIsDestroyed(true);
+    }
+    this->player_data_streams_.erase(peer);
+    it = this->peer_to_pawns_.erase(it);
+  }
 }
+
 bool Executor::IsPeerAlive(const std::shared_ptr<Peer> &peer) {
   auto &pawn = peer_to_pawns_[peer];
 
@@ -65,57 +135,74 @@ void Executor::ProcessPeer(const std::shared_ptr<Peer> &peer) {
     std::uniform_real_distribution<double> x_dist(0, world_->GetSizeX());
     std::uniform_real_distribution<double> y_dist(0, world_->GetSizeY());
 
-    auto &position = pawn->GetPosition();
-    position.SetX(x_dist(rng));
-    position.SetY(y_dist(rng));
+    pawn->SetPosition(World::Vector3(x_dist(rng), y_dist(rng), 0));
 
     peer_to_pawns_[peer] = pawn;
     world_->AddObject(std::static_pointer_cast<World::WorldObject>(pawn));
     spdlog::info("Spawning pawn id = {}, x = {}, y = {}", pawn->GetId(),
                  pawn->GetPosition().GetX(), pawn->GetPosition().GetY());
 
-    ServerClientMessage message;
-    message.mutable_game_started();
-    peer->QueueMessage(message);
+    if (!this->game_started_frame_) {
+      auto *message = this->NewMessage();
+      message->mutable_game_started();
+      this->game_started_frame_ = MakeSharedFrame(*message);
+    }
+    peer->QueueFrame(this->game_started_frame_);
     spdlog::info("Player spawned and notified");
   }
 
-  SendPlayerData(peer, pawn);
+  // Drain everything received since the last call, so input lags by one
+  // tick at most however fast the client sends
+  this->inbox_.clear();
+  peer->PopMessages(this->inbox_);
 
-  auto client_message = peer->PopMessage();
-  if (!client_message.has_value()) {
-    return;
+  // Only the last set_speed matters, the previous ones are superseded
+  size_t last_set_speed = this->inbox_.size();
+  for (size_t i = 0; i < this->inbox_.size(); i++) {
+    if (this->inbox_[i].has_set_speed()) {
+      last_set_speed = i;
+    }
   }
-  if (client_message->get_world_info()) {
-    HandleWorldInfoRequest(peer);
-  } else if (client_message->has_set_speed()) {
-    HandleSetSpeed(peer, *client_message, pawn);
-  } else if (client_message->has_radar_ping()) {
-    HandleRadarPing(peer);
-  } else if (client_message->has_shoot()) {
-    HandleShoot(peer, *client_message);
+
+  for (size_t i = 0; i < this->inbox_.size(); i++) {
+    const auto &client_message = this->inbox_[i];
+    if (client_message.get_world_info()) {
+      HandleWorldInfoRequest(peer);
+    } else if (client_message.has_set_speed()) {
+      if (i == last_set_speed) {
+        HandleSetSpeed(peer, client_message, pawn);
+      }
+    } else if (client_message.has_radar_ping()) {
+      HandleRadarPing(peer, pawn);
+    } else if (client_message.get_static_geometry()) {
+      peer->QueueFrame(this->radar_cache_->GetStatic(*world_->GetSnapshot()));
+    } else if (client_message.has_shoot()) {
+      this->pending_shots_.emplace_back(peer, client_message);
+    }
   }
 }
 
-void Executor::SendPlayerData(const std::shared_ptr<Peer> &peer,
-                              const std::shared_ptr<World::Pawn> &pawn) {
-  ServerClientMessage message;
-  PlayerData *pd = new PlayerData();
+/**
+ * Copy a world vector into its message
+ */
+static void SetVector3(Vector3 *message, const World::Vector3 &vector) {
+  message->set_x(vector.GetX());
+  message->set_y(vector.GetY());
+  message->set_z(vector.GetZ());
+}
 
-  auto position = pawn->GetPosition();
-  auto speed = pawn->GetSpeed();
+ServerClientMessage *Executor::NewMessage() {
+  return google::protobuf::Arena::CreateMessage<ServerClientMessage>(
+      &this->arena_);
+}
 
-  Vector3 *position_message = new Vector3();
-  position_message->set_x(position.GetX());
-  position_message->set_y(position.GetY());
-  position_message->set_z(position.GetZ());
-  pd->set_allocated_position(position_message);
+void Executor::SendPlayerData(const std::shared_ptr<Peer> &peer,
+                              const std::shared_ptr<World::Pawn> &pawn) {
+  auto *message = this->NewMessage();
+  PlayerData *pd = message->mutable_player_data();
 
-  Vector3 *speed_message = new Vector3();
-  speed_message->set_x(speed.GetX());
-  speed_message->set_y(speed.GetY());
-  speed_message->set_z(speed.GetZ());
-  pd->set_allocated_speed(speed_message);
+  SetVector3(pd->mutable_position(), pawn->GetPosition());
+  SetVector3(pd->mutable_speed(), pawn->GetSpeed());
 
   pd->set_id(pawn->GetId());
   pd->set_armor(pawn->GetArmor());
@@ -123,69 +210,58 @@ void Executor::SendPlayerData(const std::shared_ptr<Peer> &peer,
   pd->set_score(pawn->GetScore());
   pd->set_alive(!pawn->IsDestroyed());
 
-  message.set_allocated_player_data(pd);
-
-  peer->QueueMessage(message);
+  if (peer->SupportsDelta() &&
+      !this->player_data_streams_[peer].Strip(
+          *pd, peer->HasPendingPlayerData())) {
+    return;
+  }
+  peer->QueueMessage(*message);
 }
 
 void Executor::HandleWorldInfoRequest(const std::shared_ptr<Peer> &peer) {
-  ServerClientMessage message;
-  WorldOptions *wo = new WorldOptions();
-  wo->set_map_x(world_->GetSizeX());
-  wo->set_map_y(world_->GetSizeY());
-  wo->set_auto_shoot_allowed(false);
-  wo->set_grid_based(false);
-  wo->set_max_players(32);
-  wo->set_radar_enabled(true);
-  message.set_allocated_world_options(wo);
-
-  peer->QueueMessage(message);
+  // The options are the same for every peer, encode them once
+  if (!this->world_options_frame_) {
+    auto *message = this->NewMessage();
+    WorldOptions *wo = message->mutable_world_options();
+    wo->set_map_x(world_->GetSizeX());
+    wo->set_map_y(world_->GetSizeY());
+    wo->set_auto_shoot_allowed(false);
+    wo->set_grid_based(false);
+    wo->set_max_players(32);
+    wo->set_radar_enabled(true);
+    wo->set_radar_range(world_->GetRadarRange());
+    this->world_options_frame_ = MakeSharedFrame(*message);
+  }
+
+  peer->QueueFrame(this->world_options_frame_);
 }
 
 void Executor::HandleSetSpeed(const std::shared_ptr<Peer> &peer,
                               const ClientServerMessage &message,
                               const std::shared_ptr<World::Pawn> &pawn) {
   auto set_speed_message = message.set_speed();
-  auto &target_speed = pawn->GetTargetSpeed();
-  target_speed.SetX(set_speed_message.x());
-  target_speed.SetY(set_speed_message.y());
-  target_speed.SetZ(set_speed_message.z());
+  pawn->SetTargetSpeed(World::Vector3(
+      set_speed_message.x(), set_speed_message.y(), set_speed_message.z()));
 }
 
-void Executor::HandleRadarPing(const std::shared_ptr<Peer> &peer) {
-  ServerClientMessage message;
-  RadarResult *radar_result = new RadarResult();
+void Executor::HandleRadarPing(const std::shared_ptr<Peer> &peer,
+                               const std::shared_ptr<World::Pawn> &pawn) {
+  auto snapshot = world_->GetSnapshot();
+  bool include_static = !peer->RadarSkipsStatic();
+  double range = world_->GetRadarRange();
 
-  for (const auto &obj : world_->GetWorldObjects()) {
-    if (obj->GetWorldObjectType() == World::WorldObjectType::UNKNOWN) {
-      continue;
-    }
-
-    RadarReturn *radar_return = radar_result->add_radar_return();
-    radar_return->set_id(obj->GetId());
-
-    Vector3 *position = new Vector3();
-    position->set_x(obj->GetPosition().GetX());
-    position->set_y(obj->GetPosition().GetY());
-    position->set_z(obj->GetPosition().GetZ());
-    radar_return->set_allocated_position(position);
-
-    Vector3 *speed = new Vector3();
-    speed->set_x(obj->GetSpeed().GetX());
-    speed->set_y(obj->GetSpeed().GetY());
-    speed->set_z(obj->GetSpeed().GetZ());
-    radar_return->set_allocated_speed(speed);
-
-    radar_return->set_return_type(
-        obj->GetWorldObjectType() == World::WorldObjectType::PAWN
-            ? ::RadarReturnType::PLAYER
-        : obj->GetWorldObjectType() == World::WorldObjectType::BOOST
-            ? ::RadarReturnType::BOOST
-            : ::RadarReturnType::WALL);
+  if (range <= 0) {
+    // Every ping of a tick gets the same bytes
+    peer->QueueFrame(this->radar_cache_->Get(*snapshot, include_static));
+    return;
   }
 
-  message.set_allocated_radar_result(radar_result);
-  peer->QueueMessage(message);
+  // Only what is around the pawn, so the result doesn't grow with the map
+  EncodedFrame frame;
+  auto position = pawn->GetPosition();
+  this->radar_cache_->GetInRange(*snapshot, position.GetX(), position.GetY(),
+                                range, include_static, frame);
+  peer->QueueFrame(std::move(frame));
 }
 
 void Executor::HandleShoot(const std::shared_ptr<Peer> &peer,
@@ -193,14 +269,15 @@ void Executor::HandleShoot(const std::shared_ptr<Peer> &peer,
   auto shoot_message = message.shoot();
   std::shared_ptr<World::WorldObject> target;
 
-  ShootResult *shoot_result_message = new ShootResult();
-
   auto &pawn = peer_to_pawns_[peer];
 
   if (!pawn) {
     return;
   }
 
+  auto *response_message = this->NewMessage();
+  ShootResult *shoot_result_message = response_message->mutable_shoot_result();
+
   if (!pawn->RegisterShoot()) {
     spdlog::warn("Shot denied for pawn ID {}", pawn->GetId());
     shoot_result_message->set_success(false);
@@ -211,7 +288,9 @@ void Executor::HandleShoot(const std::shared_ptr<Peer> &peer,
   spdlog::info("Received shoot request from pawn ID: {}", pawn->GetId());
   if (shoot_message.has_target_id()) {
     target = world_->GetWorldObjectById(shoot_message.target_id());
-    if (target &&
+    // Several shots of a tick may aim at the same pawn, the ones after its
+    // destruction miss
+    if (target && !target->IsDestroyed() &&
         target->GetWorldObjectType() == World::WorldObjectType::PAWN) {
       shoot_result_message->set_target_id(shoot_message.target_id());
       shoot_result_message->set_success(true);
@@ -233,36 +312,18 @@ void Executor::HandleShoot(const std::shared_ptr<Peer> &peer,
     World::Vector3 direction((double)std::cos(angle), (double)std::sin(angle),
                              (double)0.0f);
 
-    // Simulate ray tracing to find the first target hit
+    // Nearest object crossed by the shot
     double max_range = 1000.0; // Maximum shooting range
-    double step = 1.0;         // Step size for ray trace
-    World::Vector3 current_position = shooter_position;
-
-    for (double distance = 0.0; distance < max_range; distance += step) {
-      current_position.SetX(current_position.GetX() + direction.GetX() * step);
-      current_position.SetY(current_position.GetY() + direction.GetY() * step);
-
-      // Check for collisions with objects
-      for (auto &world_object : world_->GetWorldObjects()) {
-        if (!world_object || world_object->IsDestroyed() ||
-            world_object->GetId() == pawn->GetId()) {
-          continue;
-        }
-
-        // Calculate distance to the object
-        auto object_position = world_object->GetPosition();
-        double object_distance = std::sqrt(
-            std::pow(object_position.GetX() - current_position.GetX(), 2) +
-            std::pow(object_position.GetY() - current_position.GetY(), 2));
-
-        if (object_distance <= world_object->GetRadius()) {
-          target = world_object;
-          break;
-        }
-      }
-
-      if (target) {
-        break;
+    auto hit = world_->RayCast(shooter_position, direction, max_range,
+                               pawn->GetId());
+    if (hit) {
+      target = hit->state_.handle_.IsNull()
+                   ? world_->GetWorldObjectById(hit->state_.id_)
+                   : world_->GetWorldObject(hit->state_.handle_);
+      // The snapshot predates the shots of this tick, a pawn one of them
+      // destroyed is only retired at the next step
+      if (target && target->IsDestroyed()) {
+        target = nullptr;
       }
     }
 
@@ -280,7 +341,7 @@ void Executor::HandleShoot(const std::shared_ptr<Peer> &peer,
           shoot_result_message->set_target_destroyed(true);
         }
       }
-      this->visualizer_->DrawShoot(pawn->GetPosition(), target->GetPosition());
+      this->visualizer_->DrawShoot(shooter_position, hit->state_.position_);
     } else {
       shoot_result_message->set_success(false); // No target hit
       shoot_result_message->set_fail_reason(ShootFailReason::MISS);
@@ -288,18 +349,18 @@ void Executor::HandleShoot(const std::shared_ptr<Peer> &peer,
   }
 
 send_response:
-  ServerClientMessage response_message;
-  response_message.set_allocated_shoot_result(shoot_result_message);
-  peer->QueueMessage(response_message);
+  peer->QueueMessage(*response_message);
 }
 
 void Executor::BroadcastGameEnded() {
-  for (const auto &peer : server_->GetPeers()) {
-    if (peer->GetPeerType() == PeerType::PAWN) {
+  auto *message = this->NewMessage();
+  message->mutable_game_ended()->set_reason(GameEndedReason::GAME_STOPPED);
+  auto frame = MakeSharedFrame(*message);
+  this->arena_.Reset();
 
-      ServerClientMessage message;
-      message.mutable_game_ended()->set_reason(GameEndedReason::GAME_STOPPED);
-      peer->QueueMessage(message);
+  for (const auto &peer : peers_->GetPeers()) {
+    if (peer->GetPeerType() == PeerType::PAWN) {
+      peer->QueueFrame(frame);
     }
   }
   spdlog::info("Broadcasted game_ended");
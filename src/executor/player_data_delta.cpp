@@ -0,0 +1,99 @@
+#include "executor/player_data_delta.hpp"
+#include "constants.hpp"
+#include <cstdint>
+
+using PlayerData = battle_c::PlayerData;
+using Vector3 = battle_c::Vector3;
+
+namespace {
+enum PlayerDataField : uint32_t {
+  POSITION = 1 << 0,
+  SPEED = 1 << 1,
+  HEALTH = 1 << 2,
+  ARMOR = 1 << 3,
+  SCORE = 1 << 4,
+  ALIVE = 1 << 5,
+  ALL_FIELDS = (1 << 6) - 1,
+  KEYFRAME = 1 << 6,
+};
+
+/**
+ * Check if two vectors of messages are equal
+ */
+bool SameVector3(const Vector3 &a, const Vector3 &b) {
+  return a.x() == b.x() && a.y() == b.y() && a.z() == b.z();
+}
+} // namespace
+
+bool PlayerDataDelta::Strip(PlayerData &pd, bool pending) {
+  if (!pending) {
+    // The client has every update published so far
+    this->untaken_ = 0;
+  }
+
+  // A keyframe replaced before it was written is sent again
+  bool keyframe = !this->has_last_ || (this->untaken_ & KEYFRAME) ||
+                  this->since_keyframe_ + 1 >= PLAYER_DATA_KEYFRAME_INTERVAL;
+  if (keyframe) {
+    this->since_keyframe_ = 0;
+    this->last_.CopyFrom(pd);
+    this->has_last_ = true;
+    this->untaken_ = ALL_FIELDS | KEYFRAME;
+    pd.set_keyframe(true);
+    return true;
+  }
+  this->since_keyframe_++;
+
+  PlayerData &last = this->last_;
+  uint32_t changed = 0;
+  if (!SameVector3(pd.position(), last.position())) {
+    last.mutable_position()->CopyFrom(pd.position());
+    changed |= POSITION;
+  }
+  if (!SameVector3(pd.speed(), last.speed())) {
+    last.mutable_speed()->CopyFrom(pd.speed());
+    changed |= SPEED;
+  }
+  if (pd.health() != last.health()) {
+    last.set_health(pd.health());
+    changed |= HEALTH;
+  }
+  if (pd.armor() != last.armor()) {
+    last.set_armor(pd.armor());
+    changed |= ARMOR;
+  }
+  if (pd.score() != last.score()) {
+    last.set_score(pd.score());
+    changed |= SCORE;
+  }
+  if (pd.alive() != last.alive()) {
+    last.set_alive(pd.alive());
+    changed |= ALIVE;
+  }
+  if (!changed) {
+    // A pending update already holds everything
+    return false;
+  }
+
+  // The fields of the update this one replaces are repeated
+  this->untaken_ |= changed;
+  if (!(this->untaken_ & POSITION)) {
+    pd.clear_position();
+  }
+  if (!(this->untaken_ & SPEED)) {
+    pd.clear_speed();
+  }
+  if (!(this->untaken_ & HEALTH)) {
+    pd.clear_health();
+  }
+  if (!(this->untaken_ & ARMOR)) {
+    pd.clear_armor();
+  }
+  if (!(this->untaken_ & SCORE)) {
+    pd.clear_score();
+  }
+  if (!(this->untaken_ & ALIVE)) {
+    pd.clear_alive();
+  }
+  return true;
+}
@@ -0,0 +1,172 @@
+#include "executor/radar_cache.hpp"
+#include "battle_c.pb.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+/**
+ * Append a protobuf base 128 varint
+ */
+static void AppendVarint(std::string &bytes, uint64_t value) {
+  while (value >= 0x80) {
+    bytes.push_back((char)(value | 0x80));
+    value >>= 7;
+  }
+  bytes.push_back((char)value);
+}
+
+// Tags of the length-delimited fields RadarResult.radar_return (1) and
+// ServerClientMessage.radar_result (6)
+static constexpr char RADAR_RETURN_TAG = (1 << 3) | 2;
+static constexpr char RADAR_RESULT_TAG = (6 << 3) | 2;
+
+static const std::string NO_RETURNS;
+
+void RadarCache::AppendReturn(const World::ObjectState &state,
+                              std::string &returns) {
+  if (state.type_ == World::WorldObjectType::UNKNOWN) {
+    return;
+  }
+
+  auto &radar_return = this->radar_return_;
+  radar_return.Clear();
+  radar_return.set_id(state.id_);
+
+  auto *position = radar_return.mutable_position();
+  position->set_x(state.position_.GetX());
+  position->set_y(state.position_.GetY());
+  position->set_z(state.position_.GetZ());
+
+  auto *speed = radar_return.mutable_speed();
+  speed->set_x(state.speed_.GetX());
+  speed->set_y(state.speed_.GetY());
+  speed->set_z(state.speed_.GetZ());
+
+  radar_return.set_return_type(state.type_ == World::WorldObjectType::PAWN
+                                   ? battle_c::RadarReturnType::PLAYER
+                               : state.type_ == World::WorldObjectType::BOOST
+                                   ? battle_c::RadarReturnType::BOOST
+                                   : battle_c::RadarReturnType::WALL);
+
+  returns.push_back(RADAR_RETURN_TAG);
+  AppendVarint(returns, radar_return.ByteSizeLong());
+  radar_return.AppendToString(&returns);
+}
+
+/**
+ * Append the frame of a ServerClientMessage whose only field is a
+ * radar_result made of the given returns
+ */
+static void AppendFrame(EncodedFrame &frame, const std::string &first,
+                        const std::string &second) {
+  uint64_t result_size = first.size() + second.size();
+  std::string header;
+  header.push_back(RADAR_RESULT_TAG);
+  AppendVarint(header, result_size);
+  uint32_t message_size = header.size() + result_size;
+
+  // Size prefix, then the message
+  frame.reserve(frame.size() + 4 + message_size);
+  frame.append((const char *)&message_size, 4);
+  frame.append(header);
+  frame.append(first);
+  frame.append(second);
+}
+
+void RadarCache::Update(const World::WorldSnapshot &snapshot) {
+  if (this->static_geometry_ != snapshot.static_geometry_) {
+    this->static_geometry_ = snapshot.static_geometry_;
+    this->static_returns_.clear();
+    this->static_offsets_.assign(1, 0);
+    this->static_frame_.reset();
+    this->frame_.reset();
+    if (this->static_geometry_) {
+      for (const auto &state : this->static_geometry_->GetStates()) {
+        this->AppendReturn(state, this->static_returns_);
+        this->static_offsets_.push_back(this->static_returns_.size());
+      }
+    }
+  }
+
+  if (this->encoded_ && this->version_ == snapshot.version_) {
+    return;
+  }
+  this->dynamic_returns_.clear();
+  this->dynamic_offsets_.assign(1, 0);
+  for (const auto &state : snapshot.objects_) {
+    this->AppendReturn(state, this->dynamic_returns_);
+    this->dynamic_offsets_.push_back(this->dynamic_returns_.size());
+  }
+  this->version_ = snapshot.version_;
+  this->encoded_ = true;
+  this->frame_.reset();
+  this->dynamic_frame_.reset();
+}
+
+SharedFrame RadarCache::Get(const World::WorldSnapshot &snapshot,
+                            bool include_static) {
+  this->Update(snapshot);
+
+  SharedFrame &cached = include_static ? this->frame_ : this->dynamic_frame_;
+  if (!cached) {
+    auto frame = std::make_shared<EncodedFrame>();
+    AppendFrame(*frame, include_static ? this->static_returns_ : NO_RETURNS,
+                this->dynamic_returns_);
+    cached = std::move(frame);
+  }
+  return cached;
+}
+
+SharedFrame RadarCache::GetStatic(const World::WorldSnapshot &snapshot) {
+  this->Update(snapshot);
+
+  if (!this->static_frame_) {
+    auto frame = std::make_shared<EncodedFrame>();
+    AppendFrame(*frame, this->static_returns_, NO_RETURNS);
+    this->static_frame_ = std::move(frame);
+  }
+  return this->static_frame_;
+}
+
+/**
+ * Check if an object overlaps the circle (x, y, range)
+ */
+static bool InRange(const World::ObjectState &state, double x, double y,
+                    double range) {
+  double dx = state.position_.GetX() - x;
+  double dy = state.position_.GetY() - y;
+  double reach = range + state.radius_;
+  return dx * dx + dy * dy <= reach * reach;
+}
+
+void RadarCache::GetInRange(const World::WorldSnapshot &snapshot, double x,
+                            double y, double range, bool include_static,
+                            EncodedFrame &frame) {
+  this->Update(snapshot);
+
+  this->selected_.clear();
+  if (include_static && this->static_geometry_) {
+    const auto &states = this->static_geometry_->GetStates();
+    this->static_geometry_->ForEachNear(x, y, range, [&](uint32_t i) {
+      if (InRange(states[i], x, y, range)) {
+        this->selected_.append(this->static_returns_,
+                               this->static_offsets_[i],
+                               this->static_offsets_[i + 1] -
+                                   this->static_offsets_[i]);
+      }
+      return false;
+    });
+  }
+  snapshot.grid_.ForEachNear(x, y, range, [&](uint32_t i) {
+    if (InRange(snapshot.objects_[i], x, y, range)) {
+      this->selected_.append(this->dynamic_returns_,
+                             this->dynamic_offsets_[i],
+                             this->dynamic_offsets_[i + 1] -
+                                 this->dynamic_offsets_[i]);
+    }
+    return false;
+  });
+
+  AppendFrame(frame, this->selected_, NO_RETURNS);
+}
@@ -1,5 +1,8 @@
 
+#include "constants.hpp"
 #include "executor/executor.hpp"
+#include "match/match_scheduler.hpp"
+#include "scheduler/task_scheduler.hpp"
 #include "server/server.hpp"
 
 #include "visualizer/visualizer.hpp"
@@ -29,7 +32,29 @@ int main(int argc, char *argv[]) {
       "Set the WebSocket visualizer port")(
       "generate-walls,g",
       boost::program_options::value<int>()->default_value(10),
-      "Set the number of random walls to generate");
+      "Set the number of random walls to generate")(
+      "tick-rate", boost::program_options::value<double>()->default_value(60),
+      "Set the number of world ticks per second")(
+      "output-rate",
+      boost::program_options::value<double>()->default_value(30),
+      "Set the number of player data updates sent per second")(
+      "io-threads",
+      boost::program_options::value<int>()->default_value(SERVER_IO_THREADS),
+      "Set the number of threads running the networking")(
+      "max-frame-size",
+      boost::program_options::value<int>()->default_value(PEER_MAX_FRAME_SIZE),
+      "Set the largest message accepted from a client, in bytes")(
+      "radar-range", boost::program_options::value<double>()->default_value(0),
+      "Set the distance the radar sees from a pawn, 0 for the whole map")(
+      "matches", boost::program_options::value<int>()->default_value(1),
+      "Set the number of matches played at the same time")(
+      "players-per-match",
+      boost::program_options::value<int>()->default_value(0),
+      "Set the number of players of a match, 0 for no limit")(
+      "worker-threads",
+      boost::program_options::value<int>()->default_value(0),
+      "Set the number of threads running the worlds' ticks, 0 for one per "
+      "core");
   boost::program_options::variables_map vm;
 
   try {
@@ -49,6 +74,14 @@ int main(int argc, char *argv[]) {
     int ws_port = vm["ws-port"].as<int>();
     std::string visualizer_type = vm["visualizer"].as<std::string>();
     int num_walls = vm["generate-walls"].as<int>();
+    double tick_rate = vm["tick-rate"].as<double>();
+    double output_rate = vm["output-rate"].as<double>();
+    int io_threads = vm["io-threads"].as<int>();
+    int max_frame_size = vm["max-frame-size"].as<int>();
+    double radar_range = vm["radar-range"].as<double>();
+    int matches = vm["matches"].as<int>();
+    int players_per_match = vm["players-per-match"].as<int>();
+    int worker_threads = vm["worker-threads"].as<int>();
 
     // Validate port and num_walls
     if (port <= 0 || port > 65535) {
@@ -61,29 +94,77 @@ int main(int argc, char *argv[]) {
                 << ". Must be non-negative.\n";
       return 1;
     }
+    if (tick_rate <= 0 || output_rate <= 0) {
+      std::cerr << "Invalid tick or output rate: " << tick_rate << ", "
+                << output_rate << ". Must be positive.\n";
+      return 1;
+    }
+    if (io_threads <= 0) {
+      std::cerr << "Invalid number of io threads: " << io_threads
+                << ". Must be positive.\n";
+      return 1;
+    }
+    if (max_frame_size <= 0) {
+      std::cerr << "Invalid max frame size: " << max_frame_size
+                << ". Must be positive.\n";
+      return 1;
+    }
+    if (radar_range < 0) {
+      std::cerr << "Invalid radar range: " << radar_range
+                << ". Must be non-negative.\n";
+      return 1;
+    }
+    if (matches <= 0 || players_per_match < 0) {
+      std::cerr << "Invalid matches or players per match: " << matches
+                << ", " << players_per_match
+                << ". Must be positive and non-negative.\n";
+      return 1;
+    }
+    if (worker_threads < 0) {
+      std::cerr << "Invalid number of worker threads: " << worker_threads
+                << ". Must be non-negative.\n";
+      return 1;
+    }
 
-    // Initialize server, world, and visualizer
-    auto server = std::make_shared<Server>();
-    server->Start(port);
-
-    while (true) {
-      spdlog::info("Starting world");
-      auto world = std::make_shared<World::World>();
-      world->Start();
-
+    // Initialize server, worlds, and visualizer
+    ServerSettings server_settings;
+    server_settings.io_threads_ = io_threads;
+    server_settings.max_frame_size_ = max_frame_size;
+    auto server = std::make_shared<Server>(server_settings);
+
+    MatchSettings match_settings;
+    match_settings.players_per_match_ = players_per_match;
+    match_settings.output_rate_ = output_rate;
+    MatchScheduler match_scheduler(server, match_settings);
+
+    // Every world ticks on the same pool of workers
+    auto task_scheduler = std::make_shared<TaskScheduler>(worker_threads);
+    task_scheduler->Start();
+
+    for (int match = 0; match < matches; match++) {
+      spdlog::info("Starting world of match {}", match);
+      World::WorldSettings world_settings;
+      world_settings.tick_rate_ = tick_rate;
+      world_settings.radar_range_ = radar_range;
+      auto world = std::make_shared<World::World>(world_settings);
+      world->SetTaskScheduler(task_scheduler);
+
+      // Static geometry is indexed when the world first starts, and kept for
+      // every round
       world->GenerateRandomWalls(
           num_walls,
           1); // Use the number of walls from the argument
       world->GenWallBounds();
 
-      // Select visualizer based on the --visualizer parameter
+      // Select visualizer based on the --visualizer parameter, only the
+      // first match is shown
       std::shared_ptr<Visualizer> visualizer;
-      if (visualizer_type == "none") {
+      if (visualizer_type == "none" || match > 0) {
         visualizer = std::make_shared<Visualizer>(world);
       }
 
 #ifdef ENABLE_RAYLIB
-      if (visualizer_type == "raylib") {
+      else if (visualizer_type == "raylib") {
         visualizer = std::make_shared<RaylibVisualizer>(world);
       }
 #endif
@@ -97,13 +178,13 @@ int main(int argc, char *argv[]) {
       }
 
       visualizer->Start();
-
-      auto executor = std::make_shared<Executor>(server, world, visualizer);
-      executor->Process();
-      spdlog::info("Cleaning up world");
-      world->Stop();
-      spdlog::info("World killed");
+      match_scheduler.AddMatch(world, visualizer);
     }
+
+    // Peers are placed into the matches as soon as they connect
+    match_scheduler.Start();
+    server->Start(port);
+    match_scheduler.Wait();
   } catch (const boost::program_options::error &ex) {
     std::cerr << "Error parsing options: " << ex.what() << "\n";
     return 1;
@@ -0,0 +1,64 @@
+#include "match/match_scheduler.hpp"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+void MatchScheduler::AddMatch(std::shared_ptr<World::World> world,
+                              std::shared_ptr<Visualizer> visualizer) {
+  auto match = std::make_unique<Match>();
+  match->peers_ = std::make_shared<PeerGroup>();
+  match->rounds_ = std::make_unique<RoundManager>(
+      match->peers_, std::move(world), std::move(visualizer),
+      this->match_settings_.output_rate_);
+
+  std::lock_guard<std::mutex> lock(this->matches_m_);
+  this->matches_.push_back(std::move(match));
+}
+
+void MatchScheduler::Place(const std::shared_ptr<Peer> &peer) {
+  std::lock_guard<std::mutex> lock(this->matches_m_);
+
+  size_t limit = this->match_settings_.players_per_match_;
+  Match *best = nullptr;
+  size_t best_size = 0;
+  size_t best_index = 0;
+  for (size_t i = 0; i < this->matches_.size(); i++) {
+    size_t size = this->matches_[i]->peers_->Size();
+    if ((limit == 0 || size < limit) && (!best || size < best_size)) {
+      best = this->matches_[i].get();
+      best_size = size;
+      best_index = i;
+    }
+  }
+
+  if (!best) {
+    spdlog::warn("Every match is full, disconnecting the peer");
+    peer->Disconnect("every match is full");
+    return;
+  }
+  best->peers_->Add(peer);
+  spdlog::info("Peer joined match {}, {} players", best_index,
+               best_size + 1);
+}
+
+void MatchScheduler::Start() {
+  this->server_->SetOnAccept(
+      [this](const std::shared_ptr<Peer> &peer) { this->Place(peer); });
+
+  std::lock_guard<std::mutex> lock(this->matches_m_);
+  for (auto &match : this->matches_) {
+    RoundManager *rounds = match->rounds_.get();
+    match->thread_ = std::thread([rounds] { rounds->Run(); });
+  }
+  spdlog::info("Running {} matches", this->matches_.size());
+}
+
+void MatchScheduler::Wait() {
+  for (auto &match : this->matches_) {
+    if (match->thread_.joinable()) {
+      match->thread_.join();
+    }
+  }
+}
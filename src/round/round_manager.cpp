@@ -0,0 +1,31 @@
+#include "round/round_manager.hpp"
+#include "executor/executor.hpp"
+#include <chrono>
+#include <memory>
+#include <spdlog/spdlog.h>
+
+void RoundManager::PlayRound() {
+  this->round_++;
+  spdlog::info("Starting round {}", this->round_);
+  this->world_->Start();
+
+  auto executor = std::make_shared<Executor>(
+      this->peers_, this->world_, this->visualizer_, this->output_rate_,
+      this->radar_cache_);
+  executor->Process();
+
+  auto begin = std::chrono::steady_clock::now();
+  this->world_->Stop();
+  this->world_->Reset();
+  spdlog::info(
+      "Round {} over, world reset in {} ms", this->round_,
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - begin)
+          .count());
+}
+
+void RoundManager::Run() {
+  while (true) {
+    this->PlayRound();
+  }
+}
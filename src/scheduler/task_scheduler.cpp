@@ -0,0 +1,207 @@
+#include "scheduler/task_scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+// Worker running on the current thread, tasks it submits stay on its queue
+static thread_local const TaskScheduler *current_scheduler = nullptr;
+static thread_local size_t current_worker = 0;
+
+/**
+ * Raise an atomic maximum
+ */
+static void UpdateMax(std::atomic<int64_t> &max, int64_t value) {
+  int64_t current = max.load(std::memory_order_relaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(current, value,
+                                    std::memory_order_relaxed)) {
+  }
+}
+
+TaskScheduler::TaskScheduler(size_t workers) {
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < workers; i++) {
+    this->workers_.push_back(std::make_unique<Worker>());
+  }
+}
+
+void TaskScheduler::Start() {
+  this->running_ = true;
+  for (size_t i = 0; i < this->workers_.size(); i++) {
+    this->threads_.emplace_back([this, i] { this->RunWorker(i); });
+  }
+  this->timer_thread_ = std::thread([this] { this->RunTimers(); });
+  this->ScheduleAt(Clock::now() + std::chrono::seconds(TASK_STATS_INTERVAL),
+                   [this] { this->ReportStats(); });
+  spdlog::info("Task scheduler running on {} workers", this->workers_.size());
+}
+
+void TaskScheduler::Stop() {
+  {
+    std::lock_guard<std::mutex> idle_lock(this->idle_m_);
+    std::lock_guard<std::mutex> timers_lock(this->timers_m_);
+    if (!this->running_) {
+      return;
+    }
+    this->running_ = false;
+  }
+  this->idle_cv_.notify_all();
+  this->timers_cv_.notify_all();
+  for (auto &thread : this->threads_) {
+    thread.join();
+  }
+  this->threads_.clear();
+  if (this->timer_thread_.joinable()) {
+    this->timer_thread_.join();
+  }
+}
+
+void TaskScheduler::Submit(Task task) {
+  this->Queue(std::move(task), Clock::now());
+}
+
+void TaskScheduler::ScheduleAt(Clock::time_point deadline, Task task) {
+  {
+    std::lock_guard<std::mutex> lock(this->timers_m_);
+    this->timers_.push(TimedTask{deadline, std::move(task)});
+  }
+  this->timers_cv_.notify_one();
+}
+
+void TaskScheduler::Queue(Task task, Clock::time_point ready) {
+  size_t worker = current_scheduler == this
+                      ? current_worker
+                      : this->next_worker_.fetch_add(
+                            1, std::memory_order_relaxed) %
+                            this->workers_.size();
+  {
+    auto &queue = *this->workers_[worker];
+    std::lock_guard<std::mutex> lock(queue.tasks_m_);
+    queue.tasks_.push_back(QueuedTask{std::move(task), ready});
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->idle_m_);
+    this->queued_++;
+  }
+  this->idle_cv_.notify_one();
+}
+
+bool TaskScheduler::Pop(size_t worker, QueuedTask &task) {
+  size_t count = this->workers_.size();
+  for (size_t i = 0; i < count; i++) {
+    // Its own queue first, then the next ones
+    auto &queue = *this->workers_[(worker + i) % count];
+    std::lock_guard<std::mutex> lock(queue.tasks_m_);
+    if (queue.tasks_.empty()) {
+      continue;
+    }
+    if (i == 0) {
+      task = std::move(queue.tasks_.front());
+      queue.tasks_.pop_front();
+    } else {
+      // The newest task of the victim, its oldest ones are served next
+      task = std::move(queue.tasks_.back());
+      queue.tasks_.pop_back();
+      this->stolen_.fetch_add(1, std::memory_order_relaxed);
+    }
+    this->queued_--;
+    return true;
+  }
+  return false;
+}
+
+void TaskScheduler::RunWorker(size_t worker) {
+  current_scheduler = this;
+  current_worker = worker;
+
+  QueuedTask task;
+  while (true) {
+    if (this->Pop(worker, task)) {
+      this->Run(task);
+      task.task_ = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(this->idle_m_);
+    this->idle_cv_.wait(
+        lock, [this] { return this->queued_ > 0 || !this->running_; });
+    if (!this->running_) {
+      return;
+    }
+  }
+}
+
+void TaskScheduler::Run(const QueuedTask &task) {
+  auto start = Clock::now();
+  task.task_();
+  auto end = Clock::now();
+
+  int64_t latency =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(start - task.ready_)
+          .count();
+  int64_t run =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+  this->tasks_.fetch_add(1, std::memory_order_relaxed);
+  this->latency_total_.fetch_add(latency, std::memory_order_relaxed);
+  UpdateMax(this->latency_max_, latency);
+  this->run_total_.fetch_add(run, std::memory_order_relaxed);
+  UpdateMax(this->run_max_, run);
+}
+
+void TaskScheduler::RunTimers() {
+  std::unique_lock<std::mutex> lock(this->timers_m_);
+  while (this->running_) {
+    if (this->timers_.empty()) {
+      this->timers_cv_.wait(lock);
+      continue;
+    }
+    auto deadline = this->timers_.top().deadline_;
+    if (Clock::now() < deadline) {
+      // Woken up earlier by a new task, which may be due sooner
+      this->timers_cv_.wait_until(lock, deadline);
+      continue;
+    }
+    // The top is only read here, moving it out would break the heap
+    Task task = this->timers_.top().task_;
+    this->timers_.pop();
+    lock.unlock();
+    this->Queue(std::move(task), deadline);
+    lock.lock();
+  }
+}
+
+TaskStats TaskScheduler::GetStats() const {
+  TaskStats stats;
+  stats.tasks_ = this->tasks_.load(std::memory_order_relaxed);
+  stats.stolen_ = this->stolen_.load(std::memory_order_relaxed);
+  stats.latency_total_ = std::chrono::nanoseconds(
+      this->latency_total_.load(std::memory_order_relaxed));
+  stats.latency_max_ = std::chrono::nanoseconds(
+      this->latency_max_.load(std::memory_order_relaxed));
+  stats.run_total_ = std::chrono::nanoseconds(
+      this->run_total_.load(std::memory_order_relaxed));
+  stats.run_max_ = std::chrono::nanoseconds(
+      this->run_max_.load(std::memory_order_relaxed));
+  return stats;
+}
+
+void TaskScheduler::ReportStats() {
+  auto stats = this->GetStats();
+  auto average = [&](std::chrono::nanoseconds total) {
+    return stats.tasks_ ? total.count() / 1000.0 / stats.tasks_ : 0.0;
+  };
+  spdlog::info("{} tasks run, {} stolen, latency avg {:.1f} us max {:.1f} us, "
+               "run avg {:.1f} us max {:.1f} us",
+               stats.tasks_, stats.stolen_, average(stats.latency_total_),
+               stats.latency_max_.count() / 1000.0, average(stats.run_total_),
+               stats.run_max_.count() / 1000.0);
+
+  this->ScheduleAt(Clock::now() + std::chrono::seconds(TASK_STATS_INTERVAL),
+                   [this] { this->ReportStats(); });
+}
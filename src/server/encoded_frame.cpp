@@ -0,0 +1,19 @@
+#include "server/encoded_frame.hpp"
+#include "battle_c.pb.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+void EncodeFrame(const battle_c::ServerClientMessage &message,
+                 EncodedFrame &frame) {
+  uint32_t size = message.ByteSizeLong();
+  frame.resize(4 + size);
+  std::memcpy(frame.data(), &size, 4);
+  message.SerializeWithCachedSizesToArray((uint8_t *)frame.data() + 4);
+}
+
+SharedFrame MakeSharedFrame(const battle_c::ServerClientMessage &message) {
+  auto frame = std::make_shared<EncodedFrame>();
+  EncodeFrame(message, *frame);
+  return frame;
+}
@@ -1,89 +1,254 @@
-
 #include "server/peer.hpp"
 #include "battle_c.pb.h"
 #include <boost/asio.hpp>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <spdlog/spdlog.h>
-#include <thread>
+#include <string>
 #include <vector>
 
 using ClientServerMessage = battle_c::ClientServerMessage;
 
-void Peer::Start() { this->handler_thread_ = std::thread(&Peer::Handle, this); }
-
-void Peer::Handle() {
-  try {
+void Peer::Start() {
+  if (this->dead_) {
+    // Disconnected while being placed, its socket is closed from the strand
+    return;
+  }
+  boost::system::error_code error;
+  auto endpoint = this->socket_.remote_endpoint(error);
+  if (!error) {
     spdlog::info("New client connected from {}:{}",
-                 this->socket_.remote_endpoint().address().to_string(),
-                 this->socket_.remote_endpoint().port());
-
-    uint32_t message_size;
+                 endpoint.address().to_string(), endpoint.port());
+  }
+  this->read_buffer_.resize(PEER_READ_BUFFER_SIZE);
+  boost::asio::post(this->socket_.get_executor(),
+                    [self = shared_from_this()] { self->Read(); });
+}
 
-    while (!this->dead_) {
+void Peer::Read() {
+  if (this->read_begin_ > 0 && this->read_end_ == this->read_buffer_.size()) {
+    // Move the partial frame left at the end back to the front
+    std::memmove(this->read_buffer_.data(),
+                 this->read_buffer_.data() + this->read_begin_,
+                 this->read_end_ - this->read_begin_);
+    this->read_end_ -= this->read_begin_;
+    this->read_begin_ = 0;
+  }
 
-      // Read message size
-      boost::asio::read(this->socket_, boost::asio::buffer(&message_size, 4));
+  this->socket_.async_read_some(
+      boost::asio::buffer(this->read_buffer_.data() + this->read_end_,
+                          this->read_buffer_.size() - this->read_end_),
+      [self = shared_from_this()](const boost::system::error_code &error,
+                                  size_t read) {
+        if (error) {
+          self->Close("Handle", error.message());
+          return;
+        }
+        self->read_end_ += read;
+        if (self->ParseFrames()) {
+          self->Read();
+        }
+      });
+}
 
-      // Read message data
-      std::vector<uint8_t> data(message_size);
-      boost::asio::read(this->socket_,
-                        boost::asio::buffer(data.data(), message_size));
+bool Peer::ParseFrames() {
+  while (this->read_end_ - this->read_begin_ >= 4) {
+    uint32_t size;
+    std::memcpy(&size, this->read_buffer_.data() + this->read_begin_, 4);
+    if (size > this->max_frame_size_) {
+      this->Close("Handle", "frame of " + std::to_string(size) +
+                                " bytes is over the limit");
+      return false;
+    }
 
-      // Parse and handle message
-      ClientServerMessage client_server_message;
-      if (!client_server_message.ParseFromArray(data.data(), data.size())) {
-        std::cerr << "Failed to parse message" << std::endl;
-        continue;
+    size_t frame_end = this->read_begin_ + 4 + size;
+    if (frame_end > this->read_end_) {
+      if (4 + size > this->read_buffer_.size()) {
+        // Only grows up to the frame size limit
+        this->read_buffer_.resize(4 + size);
       }
+      break;
+    }
 
-      if (client_server_message.has_client_init()) {
-        this->SetPeerType(client_server_message.client_init().is_spectator()
-                              ? PeerType::SPECTATOR
-                              : PeerType::PAWN);
-      } else {
-        this->recvq.push(client_server_message);
-      }
+    this->HandleMessage(this->read_buffer_.data() + this->read_begin_ + 4,
+                        size);
+    if (this->dead_) {
+      return false;
     }
-  } catch (const std::exception &e) {
-    std::cerr << "Error in Handle: " << e.what() << std::endl;
-    this->dead_ = true;
+    this->read_begin_ = frame_end;
+  }
+
+  if (this->read_begin_ == this->read_end_) {
+    this->read_begin_ = this->read_end_ = 0;
+  }
+  return true;
+}
+
+void Peer::HandleMessage(const uint8_t *data, size_t size) {
+  // Parse and handle message
+  ClientServerMessage client_server_message;
+  if (!client_server_message.ParseFromArray(data, size)) {
+    std::cerr << "Failed to parse message" << std::endl;
+    return;
+  }
+
+  if (client_server_message.has_client_init()) {
+    this->SetPeerType(client_server_message.client_init().is_spectator()
+                          ? PeerType::SPECTATOR
+                          : PeerType::PAWN);
+    this->supports_delta_ =
+        client_server_message.client_init().supports_delta();
+    this->radar_skips_static_ =
+        client_server_message.client_init().radar_skips_static();
+    return;
+  }
+  if (!this->recvq.Push(std::move(client_server_message))) {
+    this->Close("Handle", "receive queue full");
+    return;
+  }
+  if (auto on_message = std::atomic_load(&this->on_message_)) {
+    (*on_message)();
+  }
+}
+
+void Peer::Close(const char *where, const std::string &reason) {
+  // A read or write failing on the socket closed by a Disconnect() comes
+  // back here
+  if (this->closed_) {
+    return;
   }
+  this->closed_ = true;
+  std::cerr << "Error in " << where << ": " << reason << std::endl;
+  this->dead_ = true;
+
+  auto stats = this->GetStats();
+  spdlog::info("Peer closed, sent {} messages ({} bytes) in {} write calls, "
+               "skipped {} superseded player data updates",
+               stats.messages_sent_, stats.bytes_sent_, stats.write_calls_,
+               stats.telemetry_.dropped_);
+
+  boost::system::error_code ignored;
+  this->socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both,
+                         ignored);
+  this->socket_.close(ignored);
 }
 
-void Peer::QueueMessage(ServerClientMessage message) {
-  this->sendq.push(std::move(message));
+void Peer::Disconnect(const std::string &reason) {
+  if (this->dead_.exchange(true)) {
+    return;
+  }
+  boost::asio::post(this->socket_.get_executor(),
+                    [self = shared_from_this(), reason] {
+                      self->Close("Disconnect", reason);
+                    });
 }
 
-void Peer::SendQueue() {
-  try {
-    while (!this->sendq.empty() && !this->dead_) {
-      ServerClientMessage message = this->sendq.front();
-      uint64_t size = message.ByteSizeLong();
-      std::vector<uint8_t> buffer(size);
+void Peer::QueueMessage(const ServerClientMessage &message) {
+  if (message.has_player_data()) {
+    // Encoded into the slot's spare buffer, reusing its capacity
+    EncodeFrame(message, this->telemetry_slot_.Back());
+    this->telemetry_slot_.Publish();
+    this->ScheduleWrite();
+    return;
+  }
 
-      message.SerializeToArray(buffer.data(), size);
+  OutboundFrame frame;
+  EncodeFrame(message, frame.owned_);
+  this->QueueControl(std::move(frame));
+}
 
-      // Write message size
-      uint32_t packet_size = buffer.size();
-      boost::asio::write(this->socket_, boost::asio::buffer(&packet_size, 4));
+void Peer::QueueFrame(const SharedFrame &frame) {
+  OutboundFrame outbound;
+  outbound.shared_ = frame;
+  this->QueueControl(std::move(outbound));
+}
 
-      // Write message data
-      boost::asio::write(this->socket_,
-                         boost::asio::buffer(buffer.data(), size));
+void Peer::QueueFrame(EncodedFrame frame) {
+  OutboundFrame outbound;
+  outbound.owned_ = std::move(frame);
+  this->QueueControl(std::move(outbound));
+}
 
-      this->sendq.pop();
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "Error in SendQueue: " << e.what() << std::endl;
-    this->dead_ = true;
+void Peer::QueueControl(OutboundFrame frame) {
+  if (!this->control_sendq.Push(std::move(frame))) {
+    // The client stopped reading, only its own connection is dropped
+    spdlog::warn("Send queue full, disconnecting the peer");
+    this->Disconnect("send queue full");
+    return;
+  }
+  this->ScheduleWrite();
+}
+
+void Peer::ScheduleWrite() {
+  if (this->write_scheduled_.exchange(true)) {
+    return;
   }
+  boost::asio::post(this->socket_.get_executor(),
+                    [self = shared_from_this()] {
+                      self->write_scheduled_ = false;
+                      self->WriteNext();
+                    });
+}
+
+void Peer::WriteNext() {
+  if (this->writing_ || this->dead_) {
+    return;
+  }
+
+  // Gather every queued frame into one buffer, the freshest state first
+  this->write_buffer_.clear();
+  this->write_offset_ = 0;
+  uint64_t messages = 0;
+  if (const EncodedFrame *state = this->telemetry_slot_.Take()) {
+    this->write_buffer_.insert(this->write_buffer_.end(), state->begin(),
+                               state->end());
+    messages++;
+  }
+  OutboundFrame frame;
+  while (this->control_sendq.Pop(frame)) {
+    const EncodedFrame &bytes = frame.Get();
+    this->write_buffer_.insert(this->write_buffer_.end(), bytes.begin(),
+                               bytes.end());
+    messages++;
+  }
+  // Release the last shared frame now rather than at the next batch
+  frame.shared_.reset();
+  if (messages == 0) {
+    return;
+  }
+  this->messages_sent_.fetch_add(messages, std::memory_order_relaxed);
+
+  this->writing_ = true;
+  this->WriteBatch();
+}
+
+void Peer::WriteBatch() {
+  this->write_calls_.fetch_add(1, std::memory_order_relaxed);
+  this->socket_.async_write_some(
+      boost::asio::buffer(this->write_buffer_.data() + this->write_offset_,
+                          this->write_buffer_.size() - this->write_offset_),
+      [self = shared_from_this()](const boost::system::error_code &error,
+                                  size_t written) {
+        if (error) {
+          self->writing_ = false;
+          self->Close("SendQueue", error.message());
+          return;
+        }
+        self->bytes_sent_.fetch_add(written, std::memory_order_relaxed);
+        self->write_offset_ += written;
+        if (self->write_offset_ < self->write_buffer_.size()) {
+          self->WriteBatch();
+          return;
+        }
+        self->writing_ = false;
+        self->WriteNext();
+      });
 }
 
-std::optional<ClientServerMessage> Peer::PopMessage() {
-  if (!this->recvq.empty()) {
-    auto message = this->recvq.front();
-    this->recvq.pop();
-    return message;
+void Peer::PopMessages(std::vector<ClientServerMessage> &messages) {
+  ClientServerMessage message;
+  while (this->recvq.Pop(message)) {
+    messages.push_back(std::move(message));
   }
-  return {};
 }
@@ -0,0 +1,44 @@
+#include "server/peer_group.hpp"
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+void PeerGroup::RemoveDead() {
+  this->peers_.erase(std::remove_if(this->peers_.begin(), this->peers_.end(),
+                                    [](const std::shared_ptr<Peer> &peer) {
+                                      return peer->IsDead();
+                                    }),
+                     this->peers_.end());
+}
+
+void PeerGroup::Add(const std::shared_ptr<Peer> &peer) {
+  std::lock_guard<std::mutex> lock(this->peers_m_);
+  this->RemoveDead();
+  peer->SetOnMessage(this->on_message_);
+  this->peers_.push_back(peer);
+}
+
+std::vector<std::shared_ptr<Peer>> PeerGroup::GetPeers() {
+  std::lock_guard<std::mutex> lock(this->peers_m_);
+  this->RemoveDead();
+  return this->peers_;
+}
+
+size_t PeerGroup::Size() {
+  std::lock_guard<std::mutex> lock(this->peers_m_);
+  this->RemoveDead();
+  return this->peers_.size();
+}
+
+void PeerGroup::SetOnMessage(std::function<void()> on_message) {
+  std::lock_guard<std::mutex> lock(this->peers_m_);
+  this->on_message_ =
+      on_message ? std::make_shared<const std::function<void()>>(
+                       std::move(on_message))
+                 : nullptr;
+  for (const auto &peer : this->peers_) {
+    peer->SetOnMessage(this->on_message_);
+  }
+}
@@ -1,37 +1,36 @@
-
 #include "server/server.hpp"
 #include "server/peer.hpp"
 #include <boost/asio.hpp>
-#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
 #include <thread>
 #include <vector>
 
-void Server::ProcessConnections() {
-  try {
-    while (true) {
-      boost::asio::ip::tcp::socket socket(this->io_context_);
-      this->acceptor_.accept(socket);
-
-      auto peer = std::make_shared<Peer>(std::move(socket));
-      this->peers_.push_back(peer);
-      peer->Start();
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "Error in ProcessConnections: " << e.what() << std::endl;
-  }
-}
-
-void Server::WriteToPeers() {
-  while (true) {
-    for (auto &peer : this->peers_) {
-      if (peer && !peer->IsDead()) {
-        peer->SendQueue();
-      }
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-  }
+void Server::Accept() {
+  // Each connection gets its own strand, its handlers never run concurrently
+  this->acceptor_.async_accept(
+      boost::asio::make_strand(this->io_context_),
+      [this](const boost::system::error_code &error,
+             boost::asio::ip::tcp::socket socket) {
+        if (error) {
+          std::cerr << "Error in Accept: " << error.message() << std::endl;
+          if (error == boost::asio::error::operation_aborted) {
+            return;
+          }
+        } else {
+          auto peer = std::make_shared<Peer>(
+              std::move(socket), this->server_settings_.max_frame_size_);
+          if (this->on_accept_) {
+            this->on_accept_(peer);
+          }
+          peer->Start();
+        }
+        this->Accept();
+      });
 }
 
 void Server::Start(uint64_t port) {
@@ -43,9 +42,18 @@ void Server::Start(uint64_t port) {
 
     std::cout << "Server listening on port " << port << "..." << std::endl;
 
-    this->data_writer_ = std::thread(&Server::WriteToPeers, this);
-    this->process_connections_thread_ =
-        std::thread(&Server::ProcessConnections, this);
+    this->Accept();
+    size_t io_threads = this->server_settings_.io_threads_;
+    for (size_t i = 0; i < io_threads; i++) {
+      this->io_threads_.emplace_back([this] {
+        try {
+          this->io_context_.run();
+        } catch (const std::exception &e) {
+          std::cerr << "Error in io thread: " << e.what() << std::endl;
+        }
+      });
+    }
+    spdlog::info("Networking running on {} threads", io_threads);
   } catch (const std::exception &e) {
     std::cerr << "Error in Server::Start: " << e.what() << std::endl;
     exit(EXIT_FAILURE);
@@ -53,10 +61,9 @@ void Server::Start(uint64_t port) {
 }
 
 void Server::Wait() {
-  if (this->process_connections_thread_.joinable()) {
-    this->process_connections_thread_.join();
-  }
-  if (this->data_writer_.joinable()) {
-    this->data_writer_.join();
+  for (auto &thread : this->io_threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
   }
 }
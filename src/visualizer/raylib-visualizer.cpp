@@ -48,9 +48,14 @@ void RaylibVisualizer::DrawWorldObjects() {
   const double sizeX = world_->GetSizeX();
   const double sizeY = world_->GetSizeY();
 
-  for (const auto &obj : world_->GetWorldObjects()) {
-    World::Vector3 position = obj->GetPosition();
-    double radius = obj->GetRadius();
+  auto snapshot = world_->GetSnapshot();
+  if (!snapshot) {
+    return;
+  }
+
+  snapshot->ForEachObject([&](const World::ObjectState &obj) {
+    World::Vector3 position = obj.position_;
+    double radius = obj.radius_;
 
     // Normalize position to screen coordinates
     int x = static_cast<int>((position.GetX() / sizeX) * screen_width_);
@@ -59,7 +64,7 @@ void RaylibVisualizer::DrawWorldObjects() {
 
     // Determine color based on object type
     Color color;
-    switch (obj->GetWorldObjectType()) {
+    switch (obj.type_) {
     case World::WorldObjectType::PAWN:
       color = RED;
       break;
@@ -77,34 +82,26 @@ void RaylibVisualizer::DrawWorldObjects() {
     DrawCircle(x, y, r, color);
 
     // Draw health for PAWN objects
-    if (obj->GetWorldObjectType() == World::WorldObjectType::PAWN) {
-      std::shared_ptr<World::WorldObject> world_object = obj;
-
-      // Now apply dynamic_pointer_cast
-      std::shared_ptr<World::Pawn> pawn =
-          std::dynamic_pointer_cast<World::Pawn>(world_object);
-      if (pawn) {
-        char healthText[10];
-        snprintf(healthText, sizeof(healthText), "%d", pawn->GetHealth());
-        DrawText(healthText, x - 10, y - 10, 10, BLACK);
-      }
-    } else if (obj->GetWorldObjectType() == World::WorldObjectType::WALL) {
+    if (obj.type_ == World::WorldObjectType::PAWN) {
+      char healthText[10];
+      snprintf(healthText, sizeof(healthText), "%d", obj.health_);
+      DrawText(healthText, x - 10, y - 10, 10, BLACK);
+    } else if (obj.type_ == World::WorldObjectType::WALL) {
       // Draw wall as a gray rectangle
-      double radius =
-          obj->GetRadius(); // Assuming radius is the wall's half-width
+      double radius = obj.radius_; // Assuming radius is the wall's half-width
       int rectWidth = static_cast<int>((radius * 2 / sizeX) * screen_width_);
       int rectHeight = static_cast<int>((radius * 2 / sizeY) * screen_height_);
 
       DrawRectangle(x - rectWidth / 2, y - rectHeight / 2, rectWidth,
                     rectHeight, GRAY);
-    } else if (obj->GetWorldObjectType() == World::WorldObjectType::BOOST) {
+    } else if (obj.type_ == World::WorldObjectType::BOOST) {
       // Draw boost as a green circle
-      double radius = obj->GetRadius();
+      double radius = obj.radius_;
       int r = static_cast<int>((radius / sizeX) * screen_width_);
 
       DrawCircle(x, y, r, GREEN);
     }
-  }
+  });
 }
 
 void RaylibVisualizer::Start() {
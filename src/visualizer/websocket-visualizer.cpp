@@ -54,18 +54,22 @@ void WebSocketVisualizer::RunServer() {
         std::this_thread::sleep_for(std::chrono::milliseconds(200));
         json::json world_state = {{"type", "world"}};
 
-        for (const auto &obj : world_->GetWorldObjects()) {
-          if (obj->IsDestroyed()) {
-            continue;
+        auto snapshot = world_->GetSnapshot();
+        if (!snapshot) {
+          continue;
+        }
+        snapshot->ForEachObject([&](const World::ObjectState &obj) {
+          if (obj.destroyed_) {
+            return;
           }
           json::json object_data = {{"position",
-                                     {{"x", obj->GetPosition().GetX()},
-                                      {"y", obj->GetPosition().GetY()}}},
-                                    {"radius", obj->GetRadius()},
-                                    {"type", obj->GetWorldObjectType()}};
+                                     {{"x", obj.position_.GetX()},
+                                      {"y", obj.position_.GetY()}}},
+                                    {"radius", (uint64_t)obj.radius_},
+                                    {"type", obj.type_}};
 
           world_state["objects"].push_back(object_data);
-        }
+        });
 
         spdlog::debug("Broadcasting world state: {}", world_state.dump());
         BroadcastMessage(world_state.dump());
@@ -0,0 +1,50 @@
+#include "world/frame_pacer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace World {
+FramePacer::FramePacer(double tick_rate, uint32_t max_steps)
+    : frame_duration_(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / tick_rate))),
+      max_steps_(std::max<uint32_t>(1, max_steps)) {}
+
+uint32_t FramePacer::Consume(Clock::time_point now) {
+  if (now < this->deadline_) {
+    return 0;
+  }
+
+  auto late = now - this->deadline_;
+  int64_t jitter =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(late).count();
+  this->wakeups_.fetch_add(1, std::memory_order_relaxed);
+  this->jitter_total_.fetch_add(jitter, std::memory_order_relaxed);
+  int64_t jitter_max = this->jitter_max_.load(std::memory_order_relaxed);
+  while (jitter > jitter_max &&
+         !this->jitter_max_.compare_exchange_weak(
+             jitter_max, jitter, std::memory_order_relaxed)) {
+  }
+
+  // Every whole frame elapsed since the deadline is due too, the deadline
+  // moves past now and stays on the same grid
+  uint64_t due = late / this->frame_duration_ + 1;
+  uint32_t steps = std::min<uint64_t>(due, this->max_steps_);
+  this->deadline_ += due * this->frame_duration_;
+
+  this->ticks_.fetch_add(steps, std::memory_order_relaxed);
+  this->dropped_.fetch_add(due - steps, std::memory_order_relaxed);
+  return steps;
+}
+
+PacingStats FramePacer::GetStats() const {
+  PacingStats stats;
+  stats.ticks_ = this->ticks_.load(std::memory_order_relaxed);
+  stats.wakeups_ = this->wakeups_.load(std::memory_order_relaxed);
+  stats.dropped_ = this->dropped_.load(std::memory_order_relaxed);
+  stats.jitter_total_ = std::chrono::nanoseconds(
+      this->jitter_total_.load(std::memory_order_relaxed));
+  stats.jitter_max_ = std::chrono::nanoseconds(
+      this->jitter_max_.load(std::memory_order_relaxed));
+  return stats;
+}
+} // namespace World
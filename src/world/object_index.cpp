@@ -0,0 +1,93 @@
+#include "world/object_index.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace World {
+size_t ObjectIndex::Home(uint64_t id) const {
+  // splitmix64 finalizer, spreads sequential or clustered ids
+  id ^= id >> 30;
+  id *= 0xbf58476d1ce4e5b9ULL;
+  id ^= id >> 27;
+  id *= 0x94d049bb133111ebULL;
+  id ^= id >> 31;
+  return id & mask_;
+}
+
+void ObjectIndex::Grow() {
+  std::vector<Entry> entries = std::move(this->entries_);
+  size_t capacity = entries.empty() ? 64 : entries.size() * 2;
+
+  this->entries_.assign(capacity, Entry{0, 0});
+  this->mask_ = capacity - 1;
+  this->size_ = 0;
+  for (const auto &entry : entries) {
+    if (entry.id != 0) {
+      this->Insert(entry.id, entry.value);
+    }
+  }
+}
+
+void ObjectIndex::Insert(uint64_t id, uint32_t value) {
+  // Keep the load factor under 70%
+  if ((this->size_ + 1) * 10 > this->entries_.size() * 7) {
+    this->Grow();
+  }
+
+  size_t i = this->Home(id);
+  while (this->entries_[i].id != 0 && this->entries_[i].id != id) {
+    i = (i + 1) & this->mask_;
+  }
+  if (this->entries_[i].id == 0) {
+    this->entries_[i].id = id;
+    this->size_++;
+  }
+  this->entries_[i].value = value;
+}
+
+uint32_t ObjectIndex::Find(uint64_t id) const {
+  if (this->entries_.empty() || id == 0) {
+    return NOT_FOUND;
+  }
+  for (size_t i = this->Home(id); this->entries_[i].id != 0;
+       i = (i + 1) & this->mask_) {
+    if (this->entries_[i].id == id) {
+      return this->entries_[i].value;
+    }
+  }
+  return NOT_FOUND;
+}
+
+bool ObjectIndex::Erase(uint64_t id) {
+  if (this->entries_.empty() || id == 0) {
+    return false;
+  }
+  size_t hole = this->Home(id);
+  while (this->entries_[hole].id != id) {
+    if (this->entries_[hole].id == 0) {
+      return false;
+    }
+    hole = (hole + 1) & this->mask_;
+  }
+
+  // Shift back the following entries of the cluster that may fill the hole,
+  // so that no probe sequence goes through an empty entry
+  for (size_t i = (hole + 1) & this->mask_; this->entries_[i].id != 0;
+       i = (i + 1) & this->mask_) {
+    size_t home = this->Home(this->entries_[i].id);
+    if (((i - home) & this->mask_) >= ((i - hole) & this->mask_)) {
+      this->entries_[hole] = this->entries_[i];
+      hole = i;
+    }
+  }
+  this->entries_[hole].id = 0;
+  this->size_--;
+  return true;
+}
+void ObjectIndex::Clear() {
+  std::fill(this->entries_.begin(), this->entries_.end(), Entry{0, 0});
+  this->size_ = 0;
+}
+} // namespace World
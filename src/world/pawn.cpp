@@ -1,5 +1,5 @@
 #include "world/pawn.hpp"
-#include "constants.hpp"
+#include "world/physics_store.hpp"
 #include <chrono>
 #include <cstdint>
 
@@ -17,31 +17,29 @@ bool Pawn::HandleDamage(uint8_t damage) {
   return final_health == 0;
 }
 
-void Pawn::Tick() {
-  auto &speed = this->GetSpeed();
-  auto targetSpeed = this->GetTargetSpeed();
-  float rate = 0.5f;
+Vector3 Pawn::GetTargetSpeed() {
+  return store_ ? store_->GetTargetSpeed(handle_) : target_speed_;
+}
 
-  // Update speed in the X direction
-  if (speed.GetX() != targetSpeed.GetX()) {
-    double delta = rate * (targetSpeed.GetX() - speed.GetX());
-    speed.SetX(std::min(std::max(speed.GetX() + delta, (double)-MAX_SPEED_X),
-                        (double)MAX_SPEED_X));
+void Pawn::SetTargetSpeed(const Vector3 &target_speed) {
+  if (store_) {
+    store_->SetTargetSpeed(handle_, target_speed);
+  } else {
+    target_speed_ = target_speed;
   }
+}
 
-  // Update speed in the Y direction
-  if (speed.GetY() != targetSpeed.GetY()) {
-    float delta = rate * (targetSpeed.GetY() - speed.GetY());
-    speed.SetY(std::min(std::max(speed.GetY() + delta, (double)-MAX_SPEED_Y),
-                        (double)MAX_SPEED_Y));
-  }
+void Pawn::Attach(PhysicsStore *store, PhysicsHandle handle) {
+  WorldObject::Attach(store, handle);
+  store->SetTargetSpeed(handle, target_speed_);
+  store->SetFlag(handle, PHYSICS_STEERED, true);
+}
 
-  // Update speed in the Z direction
-  if (speed.GetZ() != targetSpeed.GetZ()) {
-    float delta = rate * (targetSpeed.GetZ() - speed.GetZ());
-    speed.SetZ(std::min(std::max(speed.GetZ() + delta, (double)-MAX_SPEED_Z),
-                        (double)MAX_SPEED_Z));
+void Pawn::Detach() {
+  if (store_) {
+    target_speed_ = store_->GetTargetSpeed(handle_);
   }
+  WorldObject::Detach();
 }
 
 bool Pawn::RegisterShoot() {
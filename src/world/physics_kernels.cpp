@@ -0,0 +1,223 @@
+#include "world/physics_kernels.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <spdlog/spdlog.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PHYSICS_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace World {
+
+static void IntegrateScalar(size_t count, const double *position_x,
+                            const double *position_y,
+                            const double *position_z, const double *speed_x,
+                            const double *speed_y, const double *speed_z,
+                            double delta_time, double size_x, double size_y,
+                            double *next_x, double *next_y, double *next_z,
+                            uint8_t *out_of_bounds) {
+  for (size_t i = 0; i < count; i++) {
+    next_x[i] = position_x[i] + speed_x[i] * delta_time;
+    next_y[i] = position_y[i] + speed_y[i] * delta_time;
+    next_z[i] = position_z[i] + speed_z[i] * delta_time;
+    out_of_bounds[i] = next_x[i] > size_x || next_x[i] < 0 ||
+                       next_y[i] > size_y || next_y[i] < 0;
+  }
+}
+
+static size_t FirstOverlapScalar(double x, double y, double radius,
+                                 const double *xs, const double *ys,
+                                 const double *radii, size_t count) {
+  for (size_t k = 0; k < count; k++) {
+    double dx = xs[k] - x;
+    double dy = ys[k] - y;
+    double reach = radius + radii[k];
+    if (radii[k] != 0 && dx * dx + dy * dy < reach * reach) {
+      return k;
+    }
+  }
+  return count;
+}
+
+static const PhysicsKernels kScalarKernels = {"scalar", IntegrateScalar,
+                                              FirstOverlapScalar};
+
+#ifdef PHYSICS_KERNELS_X86
+
+__attribute__((target("sse2"))) static void
+IntegrateSSE2(size_t count, const double *position_x, const double *position_y,
+              const double *position_z, const double *speed_x,
+              const double *speed_y, const double *speed_z, double delta_time,
+              double size_x, double size_y, double *next_x, double *next_y,
+              double *next_z, uint8_t *out_of_bounds) {
+  const __m128d dt = _mm_set1_pd(delta_time);
+  const __m128d max_x = _mm_set1_pd(size_x);
+  const __m128d max_y = _mm_set1_pd(size_y);
+  const __m128d zero = _mm_setzero_pd();
+
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128d x = _mm_add_pd(_mm_loadu_pd(position_x + i),
+                           _mm_mul_pd(_mm_loadu_pd(speed_x + i), dt));
+    __m128d y = _mm_add_pd(_mm_loadu_pd(position_y + i),
+                           _mm_mul_pd(_mm_loadu_pd(speed_y + i), dt));
+    __m128d z = _mm_add_pd(_mm_loadu_pd(position_z + i),
+                           _mm_mul_pd(_mm_loadu_pd(speed_z + i), dt));
+    _mm_storeu_pd(next_x + i, x);
+    _mm_storeu_pd(next_y + i, y);
+    _mm_storeu_pd(next_z + i, z);
+
+    __m128d oob = _mm_or_pd(
+        _mm_or_pd(_mm_cmpgt_pd(x, max_x), _mm_cmplt_pd(x, zero)),
+        _mm_or_pd(_mm_cmpgt_pd(y, max_y), _mm_cmplt_pd(y, zero)));
+    int mask = _mm_movemask_pd(oob);
+    out_of_bounds[i] = mask & 1;
+    out_of_bounds[i + 1] = (mask >> 1) & 1;
+  }
+  IntegrateScalar(count - i, position_x + i, position_y + i, position_z + i,
+                  speed_x + i, speed_y + i, speed_z + i, delta_time, size_x,
+                  size_y, next_x + i, next_y + i, next_z + i,
+                  out_of_bounds + i);
+}
+
+__attribute__((target("sse2"))) static size_t
+FirstOverlapSSE2(double x, double y, double radius, const double *xs,
+                 const double *ys, const double *radii, size_t count) {
+  const __m128d qx = _mm_set1_pd(x);
+  const __m128d qy = _mm_set1_pd(y);
+  const __m128d qr = _mm_set1_pd(radius);
+  const __m128d zero = _mm_setzero_pd();
+
+  size_t k = 0;
+  for (; k + 2 <= count; k += 2) {
+    __m128d r = _mm_loadu_pd(radii + k);
+    __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + k), qx);
+    __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + k), qy);
+    __m128d reach = _mm_add_pd(qr, r);
+    __m128d distance = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+    __m128d hit = _mm_and_pd(_mm_cmplt_pd(distance, _mm_mul_pd(reach, reach)),
+                             _mm_cmpneq_pd(r, zero));
+    int mask = _mm_movemask_pd(hit);
+    if (mask) {
+      return k + __builtin_ctz(mask);
+    }
+  }
+  return k + FirstOverlapScalar(x, y, radius, xs + k, ys + k, radii + k,
+                                count - k);
+}
+
+__attribute__((target("avx2"))) static void
+IntegrateAVX2(size_t count, const double *position_x, const double *position_y,
+              const double *position_z, const double *speed_x,
+              const double *speed_y, const double *speed_z, double delta_time,
+              double size_x, double size_y, double *next_x, double *next_y,
+              double *next_z, uint8_t *out_of_bounds) {
+  const __m256d dt = _mm256_set1_pd(delta_time);
+  const __m256d max_x = _mm256_set1_pd(size_x);
+  const __m256d max_y = _mm256_set1_pd(size_y);
+  const __m256d zero = _mm256_setzero_pd();
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    // No FMA, to round exactly like the scalar kernel
+    __m256d x = _mm256_add_pd(_mm256_loadu_pd(position_x + i),
+                              _mm256_mul_pd(_mm256_loadu_pd(speed_x + i), dt));
+    __m256d y = _mm256_add_pd(_mm256_loadu_pd(position_y + i),
+                              _mm256_mul_pd(_mm256_loadu_pd(speed_y + i), dt));
+    __m256d z = _mm256_add_pd(_mm256_loadu_pd(position_z + i),
+                              _mm256_mul_pd(_mm256_loadu_pd(speed_z + i), dt));
+    _mm256_storeu_pd(next_x + i, x);
+    _mm256_storeu_pd(next_y + i, y);
+    _mm256_storeu_pd(next_z + i, z);
+
+    __m256d oob =
+        _mm256_or_pd(_mm256_or_pd(_mm256_cmp_pd(x, max_x, _CMP_GT_OQ),
+                                  _mm256_cmp_pd(x, zero, _CMP_LT_OQ)),
+                     _mm256_or_pd(_mm256_cmp_pd(y, max_y, _CMP_GT_OQ),
+                                  _mm256_cmp_pd(y, zero, _CMP_LT_OQ)));
+    int mask = _mm256_movemask_pd(oob);
+    for (int lane = 0; lane < 4; lane++) {
+      out_of_bounds[i + lane] = (mask >> lane) & 1;
+    }
+  }
+  IntegrateScalar(count - i, position_x + i, position_y + i, position_z + i,
+                  speed_x + i, speed_y + i, speed_z + i, delta_time, size_x,
+                  size_y, next_x + i, next_y + i, next_z + i,
+                  out_of_bounds + i);
+}
+
+__attribute__((target("avx2"))) static size_t
+FirstOverlapAVX2(double x, double y, double radius, const double *xs,
+                 const double *ys, const double *radii, size_t count) {
+  const __m256d qx = _mm256_set1_pd(x);
+  const __m256d qy = _mm256_set1_pd(y);
+  const __m256d qr = _mm256_set1_pd(radius);
+  const __m256d zero = _mm256_setzero_pd();
+
+  size_t k = 0;
+  for (; k + 4 <= count; k += 4) {
+    __m256d r = _mm256_loadu_pd(radii + k);
+    __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + k), qx);
+    __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + k), qy);
+    __m256d reach = _mm256_add_pd(qr, r);
+    __m256d distance =
+        _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+    __m256d hit = _mm256_and_pd(
+        _mm256_cmp_pd(distance, _mm256_mul_pd(reach, reach), _CMP_LT_OQ),
+        _mm256_cmp_pd(r, zero, _CMP_NEQ_UQ));
+    int mask = _mm256_movemask_pd(hit);
+    if (mask) {
+      return k + __builtin_ctz(mask);
+    }
+  }
+  return k + FirstOverlapScalar(x, y, radius, xs + k, ys + k, radii + k,
+                                count - k);
+}
+
+static const PhysicsKernels kSSE2Kernels = {"sse2", IntegrateSSE2,
+                                            FirstOverlapSSE2};
+static const PhysicsKernels kAVX2Kernels = {"avx2", IntegrateAVX2,
+                                            FirstOverlapAVX2};
+
+#endif
+
+const PhysicsKernels &GetScalarPhysicsKernels() { return kScalarKernels; }
+
+const PhysicsKernels *GetSSE2PhysicsKernels() {
+#ifdef PHYSICS_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    return &kSSE2Kernels;
+  }
+#endif
+  return nullptr;
+}
+
+const PhysicsKernels *GetAVX2PhysicsKernels() {
+#ifdef PHYSICS_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return &kAVX2Kernels;
+  }
+#endif
+  return nullptr;
+}
+
+static const PhysicsKernels &SelectPhysicsKernels() {
+  const PhysicsKernels *kernels = GetAVX2PhysicsKernels();
+  if (!kernels) {
+    kernels = GetSSE2PhysicsKernels();
+  }
+  if (!kernels) {
+    kernels = &kScalarKernels;
+  }
+  spdlog::info("Using {} physics kernels", kernels->name);
+  return *kernels;
+}
+
+const PhysicsKernels &GetPhysicsKernels() {
+  static const PhysicsKernels &kernels = SelectPhysicsKernels();
+  return kernels;
+}
+} // namespace World
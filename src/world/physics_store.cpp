@@ -0,0 +1,69 @@
+#include "world/physics_store.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace World {
+PhysicsHandle PhysicsStore::Add(const Vector3 &position, const Vector3 &speed,
+                                double radius, uint8_t flags,
+                                WorldObjectType type) {
+  PhysicsHandle handle = this->Size();
+
+  this->position_x_.push_back(position.GetX());
+  this->position_y_.push_back(position.GetY());
+  this->position_z_.push_back(position.GetZ());
+  this->speed_x_.push_back(speed.GetX());
+  this->speed_y_.push_back(speed.GetY());
+  this->speed_z_.push_back(speed.GetZ());
+  this->target_speed_x_.push_back(0);
+  this->target_speed_y_.push_back(0);
+  this->target_speed_z_.push_back(0);
+  this->radius_.push_back(radius);
+  this->flags_.push_back(flags);
+  this->type_.push_back(type);
+
+  return handle;
+}
+
+/**
+ * Move the last element of a component into index, and drop it
+ */
+template <typename T>
+static void SwapRemoveComponent(std::vector<T> &component, size_t index) {
+  component[index] = component.back();
+  component.pop_back();
+}
+
+PhysicsHandle PhysicsStore::SwapRemove(PhysicsHandle handle) {
+  PhysicsHandle last = this->Size() - 1;
+
+  SwapRemoveComponent(this->position_x_, handle);
+  SwapRemoveComponent(this->position_y_, handle);
+  SwapRemoveComponent(this->position_z_, handle);
+  SwapRemoveComponent(this->speed_x_, handle);
+  SwapRemoveComponent(this->speed_y_, handle);
+  SwapRemoveComponent(this->speed_z_, handle);
+  SwapRemoveComponent(this->target_speed_x_, handle);
+  SwapRemoveComponent(this->target_speed_y_, handle);
+  SwapRemoveComponent(this->target_speed_z_, handle);
+  SwapRemoveComponent(this->radius_, handle);
+  SwapRemoveComponent(this->flags_, handle);
+  SwapRemoveComponent(this->type_, handle);
+
+  return last;
+}
+
+void PhysicsStore::Clear() {
+  this->position_x_.clear();
+  this->position_y_.clear();
+  this->position_z_.clear();
+  this->speed_x_.clear();
+  this->speed_y_.clear();
+  this->speed_z_.clear();
+  this->target_speed_x_.clear();
+  this->target_speed_y_.clear();
+  this->target_speed_z_.clear();
+  this->radius_.clear();
+  this->flags_.clear();
+  this->type_.clear();
+}
+} // namespace World
@@ -0,0 +1,71 @@
+#include "world/spatial_grid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace World {
+/**
+ * Clamp a cell coordinate to [0, max] before converting it, a value out of
+ * the range of int32_t, e.g. from a huge query range, can't be converted.
+ * NaN lands in cell 0
+ */
+static int32_t ClampCell(double cell, int32_t max) {
+  return (int32_t)std::max(0.0, std::min(cell, (double)max));
+}
+
+int32_t SpatialGrid::CellX(double x) const {
+  return ClampCell(std::floor(x / cell_size_), cells_x_ - 1);
+}
+
+int32_t SpatialGrid::CellY(double y) const {
+  return ClampCell(std::floor(y / cell_size_), cells_y_ - 1);
+}
+
+void SpatialGrid::Reset(double size_x, double size_y, double cell_size) {
+  this->cell_size_ = cell_size;
+  this->cells_x_ = std::max(1, (int32_t)std::ceil(size_x / cell_size));
+  this->cells_y_ = std::max(1, (int32_t)std::ceil(size_y / cell_size));
+  this->Clear();
+  this->Build();
+}
+
+void SpatialGrid::Clear() {
+  this->pending_.clear();
+  this->max_radius_ = 0;
+}
+
+void SpatialGrid::Insert(uint32_t item, double x, double y, double radius) {
+  uint32_t cell = CellY(y) * cells_x_ + CellX(x);
+  this->pending_.push_back({cell, item, x, y, radius});
+  this->max_radius_ = std::max(this->max_radius_, radius);
+}
+
+void SpatialGrid::Build() {
+  // Counting sort of the pending items by cell
+  size_t cell_count = (size_t)cells_x_ * cells_y_;
+  this->cell_start_.assign(cell_count + 1, 0);
+  for (const auto &pending : this->pending_) {
+    this->cell_start_[pending.cell + 1]++;
+  }
+  for (size_t cell = 0; cell < cell_count; cell++) {
+    this->cell_start_[cell + 1] += this->cell_start_[cell];
+  }
+
+  // Fill using cell_start_ as a write cursor, then shift it back in place
+  this->items_.resize(this->pending_.size());
+  this->item_x_.resize(this->pending_.size());
+  this->item_y_.resize(this->pending_.size());
+  this->item_radius_.resize(this->pending_.size());
+  for (const auto &pending : this->pending_) {
+    uint32_t slot = this->cell_start_[pending.cell]++;
+    this->items_[slot] = pending.item;
+    this->item_x_[slot] = pending.x;
+    this->item_y_[slot] = pending.y;
+    this->item_radius_[slot] = pending.radius;
+  }
+  for (size_t cell = cell_count; cell > 0; cell--) {
+    this->cell_start_[cell] = this->cell_start_[cell - 1];
+  }
+  this->cell_start_[0] = 0;
+}
+} // namespace World
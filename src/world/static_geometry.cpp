@@ -0,0 +1,30 @@
+#include "world/static_geometry.hpp"
+#include "constants.hpp"
+#include <memory>
+#include <vector>
+
+namespace World {
+StaticGeometry::StaticGeometry(
+    std::vector<std::shared_ptr<WorldObject>> objects, double size_x,
+    double size_y)
+    : objects_(std::move(objects)) {
+  this->grid_.Reset(size_x, size_y, GRID_CELL_SIZE);
+  for (size_t i = 0; i < this->objects_.size(); i++) {
+    auto &object = this->objects_[i];
+
+    ObjectState state;
+    state.id_ = object->GetId();
+    state.type_ = object->GetWorldObjectType();
+    state.position_ = object->GetPosition();
+    state.speed_ = object->GetSpeed();
+    state.radius_ = object->GetRadius();
+    state.destroyed_ = object->IsDestroyed();
+    this->states_.push_back(state);
+    this->index_.Insert(state.id_, i);
+
+    this->grid_.Insert(i, state.position_.GetX(), state.position_.GetY(),
+                       state.radius_);
+  }
+  this->grid_.Build();
+}
+} // namespace World
@@ -2,14 +2,18 @@
 #include "constants.hpp"
 #include "world/boost.hpp"
 #include "world/pawn.hpp"
+#include "world/physics_kernels.hpp"
+#include "world/physics_store.hpp"
 #include "world/vector3.hpp"
 #include "world/wall.hpp"
 #include "world/world_object.hpp"
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <random>
 #include <spdlog/spdlog.h>
 #include <thread>
@@ -18,124 +22,474 @@ namespace World {
 void World::AddObject(std::shared_ptr<WorldObject> wo) {
   std::lock_guard<std::mutex> lock(wo_m);
 
+  if (wo->IsStatic()) {
+    this->static_objects_.push_back(wo);
+    this->static_geometry_dirty_ = true;
+    return;
+  }
+  PhysicsHandle handle = this->physics_store_.Add(
+      wo->GetPosition(), wo->GetSpeed(), wo->GetRadius(),
+      wo->IsDestroyed() ? PHYSICS_DESTROYED : 0, wo->GetWorldObjectType());
+  wo->Attach(&this->physics_store_, handle);
   this->world_objects_.push_back(wo);
+
+  uint32_t slot;
+  if (!this->free_slots_.empty()) {
+    slot = this->free_slots_.back();
+    this->free_slots_.pop_back();
+  } else {
+    slot = this->slots_.size();
+    this->slots_.emplace_back();
+  }
+  this->slots_[slot].dense_ = handle;
+  this->dense_slots_.push_back(slot);
+  this->id_index_.Insert(wo->GetId(), slot);
+}
+
+void World::ReleaseSlot(PhysicsHandle handle) {
+  uint32_t slot = this->dense_slots_[handle];
+  this->id_index_.Erase(this->world_objects_[handle]->GetId());
+  this->slots_[slot].generation_++;
+  this->free_slots_.push_back(slot);
+  this->dense_slots_[handle] = NO_SLOT;
+}
+
+void World::RetireDestroyed() {
+  auto &store = this->physics_store_;
+  PhysicsHandle i = 0;
+  while (i < store.Size()) {
+    if (!store.HasFlag(i, PHYSICS_DESTROYED)) {
+      i++;
+      continue;
+    }
+    if (this->dense_slots_[i] != NO_SLOT) {
+      this->ReleaseSlot(i);
+    }
+    // Its owner may still hold it, e.g. the executor a dead pawn
+    this->world_objects_[i]->Detach();
+
+    // The last object takes its place, its slot follows it
+    PhysicsHandle moved = store.SwapRemove(i);
+    if (moved != i) {
+      this->world_objects_[i] = std::move(this->world_objects_[moved]);
+      this->world_objects_[i]->SetPhysicsHandle(i);
+      this->dense_slots_[i] = this->dense_slots_[moved];
+      if (this->dense_slots_[i] != NO_SLOT) {
+        this->slots_[this->dense_slots_[i]].dense_ = i;
+      }
+    }
+    this->world_objects_.pop_back();
+    this->dense_slots_.pop_back();
+  }
+}
+
+std::shared_ptr<const StaticGeometry> World::GetStaticGeometry() const {
+  return std::atomic_load(&this->static_geometry_);
+}
+
+void World::BuildStaticGeometry() {
+  auto static_geometry = std::make_shared<const StaticGeometry>(
+      this->static_objects_, this->world_settings_.sizeX_,
+      this->world_settings_.sizeY_);
+  std::atomic_store(&this->static_geometry_, std::move(static_geometry));
+  this->static_geometry_dirty_ = false;
+}
+
+std::shared_ptr<const WorldSnapshot> World::GetSnapshot() const {
+  return std::atomic_load(&this->snapshot_);
+}
+
+void World::PublishSnapshot() {
+  // Refill the previous snapshot if no reader holds it anymore, otherwise
+  // leave it to its readers and allocate a new one
+  if (this->back_snapshot_ && this->back_snapshot_.use_count() == 1) {
+    // Pairs with the release of the last reader's reference
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } else {
+    this->back_snapshot_ = std::make_shared<WorldSnapshot>();
+    this->back_snapshot_->grid_.Reset(this->world_settings_.sizeX_,
+                                      this->world_settings_.sizeY_,
+                                      GRID_CELL_SIZE);
+  }
+
+  auto &snapshot = *this->back_snapshot_;
+  snapshot.version_ = ++this->snapshot_version_;
+  snapshot.static_geometry_ = this->static_geometry_;
+  snapshot.objects_.resize(this->world_objects_.size());
+  snapshot.grid_.Clear();
+  for (size_t i = 0; i < this->world_objects_.size(); i++) {
+    auto &world_object = this->world_objects_[i];
+    auto &state = snapshot.objects_[i];
+    state.id_ = world_object->GetId();
+    state.handle_ = ObjectHandle();
+    if (this->dense_slots_[i] != NO_SLOT) {
+      state.handle_.slot_ = this->dense_slots_[i];
+      state.handle_.generation_ = this->slots_[state.handle_.slot_].generation_;
+    }
+    state.type_ = this->physics_store_.GetType(i);
+    state.position_ = this->physics_store_.GetPosition(i);
+    state.speed_ = this->physics_store_.GetSpeed(i);
+    state.radius_ = this->physics_store_.GetRadius(i);
+    state.destroyed_ = this->physics_store_.HasFlag(i, PHYSICS_DESTROYED);
+    state.health_ = 0;
+    if (state.type_ == WorldObjectType::PAWN) {
+      auto pawn = dynamic_cast<Pawn *>(world_object.get());
+      state.health_ = pawn ? pawn->GetHealth() : 0;
+    }
+    if (!state.destroyed_) {
+      snapshot.grid_.Insert(i, state.position_.GetX(), state.position_.GetY(),
+                            state.radius_);
+    }
+  }
+  snapshot.grid_.Build();
+
+  std::atomic_store(
+      &this->snapshot_,
+      std::shared_ptr<const WorldSnapshot>(this->back_snapshot_));
+  std::swap(this->front_snapshot_, this->back_snapshot_);
 }
 
-std::vector<std::shared_ptr<WorldObject>> &World::GetWorldObjects() {
-  return world_objects_;
+std::optional<RayHit> World::RayCast(const Vector3 &origin,
+                                     const Vector3 &direction,
+                                     double max_distance,
+                                     uint64_t ignore_id) const {
+  auto snapshot = this->GetSnapshot();
+  if (!snapshot) {
+    return std::nullopt;
+  }
+  return snapshot->RayCast(origin, direction, max_distance, ignore_id);
 }
 
 void World::Start() {
-  this->is_running_ = true;
-  this->process_thread_ = std::thread(&World::Process, this);
+  {
+    std::lock_guard<std::mutex> lock(wo_m);
+    // Kept from the previous round, unless walls were added since
+    if (!this->static_geometry_ || this->static_geometry_dirty_) {
+      this->BuildStaticGeometry();
+    }
+    this->grid_.Reset(this->world_settings_.sizeX_,
+                      this->world_settings_.sizeY_, GRID_CELL_SIZE);
+    this->PublishSnapshot();
+  }
+  {
+    std::scoped_lock lock(this->tick_m_, this->tasks_m_);
+    this->is_running_ = true;
+  }
+  this->pacer_.Start(std::chrono::steady_clock::now());
+  if (this->scheduler_) {
+    this->ScheduleTick();
+  } else {
+    this->process_thread_ = std::thread(&World::Process, this);
+  }
   spdlog::info("World started");
 }
 void World::Stop() {
   spdlog::info("Stopping the world.");
-  this->is_running_ = false;
+  {
+    // No task begins once it is cleared, and the world thread wakes up
+    std::scoped_lock lock(this->tick_m_, this->tasks_m_);
+    this->is_running_ = false;
+  }
+  this->tick_cv_.notify_one();
   if (this->process_thread_.joinable()) {
     this->process_thread_.join();
   }
-  spdlog::info("World stopped");
+  {
+    // The tick queued to the scheduler returns at the latest when it is due
+    std::unique_lock<std::mutex> lock(this->tasks_m_);
+    this->tasks_cv_.wait(lock,
+                         [this] { return this->tasks_in_flight_ == 0; });
+  }
+
+  auto stats = this->pacer_.GetStats();
+  spdlog::info("World stopped after {} ticks, jitter avg {:.1f} us max {:.1f} "
+               "us, {} ticks dropped",
+               stats.ticks_,
+               stats.wakeups_ ? stats.jitter_total_.count() / 1000.0 /
+                                    stats.wakeups_
+                              : 0.0,
+               stats.jitter_max_.count() / 1000.0, stats.dropped_);
 }
 
-void World::Process() {
-  using namespace std::chrono;
+void World::Reset() {
+  std::lock_guard<std::mutex> lock(wo_m);
+  // The previous round's owners may still hold their objects
+  for (auto &world_object : this->world_objects_) {
+    world_object->Detach();
+  }
+  this->world_objects_.clear();
+  this->physics_store_.Clear();
+  this->slots_.clear();
+  this->free_slots_.clear();
+  this->dense_slots_.clear();
+  this->id_index_.Clear();
+  // The snapshot versions go on, so a new round's never match an old one
+  {
+    std::lock_guard<std::mutex> tick_lock(this->tick_m_);
+    this->notified_ = false;
+  }
+  this->input_queued_ = false;
+}
+
+void World::SetTickListener(std::shared_ptr<TickListener> listener) {
+  std::lock_guard<std::mutex> listener_lock(this->listener_m_);
+  std::lock_guard<std::mutex> lock(this->tick_m_);
+  this->listener_ = std::move(listener);
+}
+
+void World::Notify() {
+  if (this->scheduler_) {
+    // A single input task queued at a time, however many messages arrive
+    if (!this->input_queued_.exchange(true)) {
+      if (this->BeginTask()) {
+        this->scheduler_->Submit([this] {
+          this->RunInputTask();
+          this->EndTask();
+        });
+      } else {
+        this->input_queued_ = false;
+      }
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->tick_m_);
+    this->notified_ = true;
+  }
+  this->tick_cv_.notify_one();
+}
+
+bool World::BeginTask() {
+  std::lock_guard<std::mutex> lock(this->tasks_m_);
+  if (!this->is_running_) {
+    return false;
+  }
+  this->tasks_in_flight_++;
+  return true;
+}
+
+void World::EndTask() {
+  {
+    std::lock_guard<std::mutex> lock(this->tasks_m_);
+    this->tasks_in_flight_--;
+  }
+  this->tasks_cv_.notify_all();
+}
+
+void World::ScheduleTick() {
+  if (!this->BeginTask()) {
+    return;
+  }
+  this->scheduler_->ScheduleAt(this->pacer_.GetDeadline(), [this] {
+    this->RunTickTask();
+    this->EndTask();
+  });
+}
+
+void World::RunTickTask() {
+  if (!this->is_running_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> listener_lock(this->listener_m_);
+    this->input_queued_ = false;
+    if (this->listener_) {
+      this->listener_->OnInput();
+    }
+    this->RunDueTicks();
+  }
+  this->ScheduleTick();
+}
 
-  const int target_fps = 60;
-  const double delta_time = (double)1 / (double)target_fps;
-  ;
-  // Define the time per frame for 60 FPS
-  const milliseconds frameDuration(1000 / target_fps);
+void World::RunInputTask() {
+  if (!this->is_running_) {
+    // Queued just before Stop(), the next round must queue its own
+    this->input_queued_ = false;
+    return;
+  }
+  // Waits for the tick of the world if it is running on another worker
+  std::lock_guard<std::mutex> listener_lock(this->listener_m_);
+  this->input_queued_ = false;
+  if (this->listener_) {
+    this->listener_->OnInput();
+  }
+}
 
-  auto lastTime = steady_clock::now();
+void World::RunDueTicks() {
+  uint32_t steps = this->pacer_.Consume(std::chrono::steady_clock::now());
+  for (uint32_t i = 0; i < steps; i++) {
+    this->Tick();
+  }
+}
 
+void World::Tick() {
+  {
+    std::lock_guard<std::mutex> lock(wo_m);
+    this->Step(1.0 / this->world_settings_.tick_rate_);
+    this->tick_++;
+    this->PublishSnapshot();
+  }
+  if (this->listener_) {
+    this->listener_->OnTick(this->tick_);
+  }
+}
+
+void World::Process() {
   while (this->is_running_) {
-    auto currentTime = steady_clock::now();
-    auto elapsedTime = duration_cast<milliseconds>(currentTime - lastTime);
-
-    if (elapsedTime >= frameDuration) {
-      lastTime += frameDuration;
-
-      {
-        std::lock_guard<std::mutex> lock(wo_m);
-        auto wos = this->GetWorldObjects();
-        for (auto &world_object : wos) {
-          if (world_object->IsDestroyed()) {
-            continue;
-          }
-          try {
-            world_object->Tick();
-          } catch (std::exception e) {
-            spdlog::error("Could not tick {} {}", world_object->GetId(),
-                          e.what());
-          }
-          Vector3 &position = world_object->GetPosition();
-          Vector3 &speed = world_object->GetSpeed();
-          Vector3 new_position(position.GetX() + speed.GetX() * delta_time,
-                               position.GetY() + speed.GetY() * delta_time,
-                               position.GetZ() + speed.GetZ() * delta_time);
-          // OOB Check
-          if (new_position.GetX() > this->world_settings_.sizeX_ ||
-              new_position.GetX() < 0 ||
-              new_position.GetY() > this->world_settings_.sizeY_ ||
-              new_position.GetY() < 0) {
-            if (speed.GetX() > EPSILON) {
-              speed.SetX(0);
-              speed.SetY(0);
-            }
-            continue;
-          }
-
-          {
-            // Collision check
-            for (auto &world_object_2 : wos) {
-              if (world_object_2->IsDestroyed()) {
-                continue;
-              }
-              Vector3 &wo_2_position = world_object_2->GetPosition();
-
-              int distance = std::sqrt(
-                  std::pow(wo_2_position.GetX() - new_position.GetX(), 2) +
-                  std::pow(wo_2_position.GetY() - new_position.GetY(), 2));
-
-              if (world_object_2->GetRadius() != 0 &&
-                  world_object->GetRadius() != 0 &&
-                  distance < (world_object_2->GetRadius() +
-                              world_object->GetRadius())) {
-                // Collision detected!
-                world_object_2->HandleCollision(world_object);
-                world_object->HandleCollision(world_object_2);
-                break;
-              }
-            }
-          }
-
-          // Update position
-          position.SetX(new_position.GetX());
-          position.SetY(new_position.GetY());
-          position.SetZ(new_position.GetZ());
+    {
+      // Sleep until the next tick, or until some input arrives
+      std::unique_lock<std::mutex> lock(this->tick_m_);
+      this->tick_cv_.wait_until(lock, this->pacer_.GetDeadline(), [this] {
+        return this->notified_ || !this->is_running_;
+      });
+      this->notified_ = false;
+    }
+    if (!this->is_running_) {
+      break;
+    }
+
+    // Input is handled at every wakeup, the world steps when a tick is due
+    std::lock_guard<std::mutex> listener_lock(this->listener_m_);
+    if (this->listener_) {
+      this->listener_->OnInput();
+    }
+    this->RunDueTicks();
+  }
+}
+/**
+ * Move a speed halfway toward its target, within [-max_speed, max_speed]
+ */
+static double Steer(double speed, double target_speed, double max_speed) {
+  return std::clamp(speed + 0.5 * (target_speed - speed), -max_speed,
+                    max_speed);
+}
+
+void World::Step(double delta_time) {
+  // Static objects are only expected at generation, but stay consistent if
+  // some are added later on
+  if (this->static_geometry_dirty_) {
+    this->BuildStaticGeometry();
+  }
+  const auto &static_geometry = *this->static_geometry_;
+
+  // Objects destroyed during the previous tick were published once, they
+  // leave the tick set now
+  this->RetireDestroyed();
+
+  auto &store = this->physics_store_;
+  const uint32_t count = store.Size();
+  double *position_x = store.PositionX();
+  double *position_y = store.PositionY();
+  double *position_z = store.PositionZ();
+  double *speed_x = store.SpeedX();
+  double *speed_y = store.SpeedY();
+  double *speed_z = store.SpeedZ();
+  const double *target_speed_x = store.TargetSpeedX();
+  const double *target_speed_y = store.TargetSpeedY();
+  const double *target_speed_z = store.TargetSpeedZ();
+  const double *radius = store.Radius();
+  const uint8_t *flags = store.Flags();
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (flags[i] & PHYSICS_STEERED) {
+      speed_x[i] = Steer(speed_x[i], target_speed_x[i], MAX_SPEED_X);
+      speed_y[i] = Steer(speed_y[i], target_speed_y[i], MAX_SPEED_Y);
+      speed_z[i] = Steer(speed_z[i], target_speed_z[i], MAX_SPEED_Z);
+    }
+  }
+
+  // Broadphase: bucket the live objects by their position at the start of
+  // the frame, so each object only tests its neighbourhood
+  this->grid_.Clear();
+  for (uint32_t i = 0; i < count; i++) {
+    if (!(flags[i] & PHYSICS_DESTROYED)) {
+      this->grid_.Insert(i, position_x[i], position_y[i], radius[i]);
+    }
+  }
+  this->grid_.Build();
+
+  // Integration and OOB check, vectorized over the whole store
+  this->next_x_.resize(count);
+  this->next_y_.resize(count);
+  this->next_z_.resize(count);
+  this->out_of_bounds_.resize(count);
+  GetPhysicsKernels().integrate(
+      count, position_x, position_y, position_z, speed_x, speed_y, speed_z,
+      delta_time, this->world_settings_.sizeX_, this->world_settings_.sizeY_,
+      this->next_x_.data(), this->next_y_.data(), this->next_z_.data(),
+      this->out_of_bounds_.data());
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (flags[i] & PHYSICS_DESTROYED) {
+      continue;
+    }
+
+    if (this->out_of_bounds_[i]) {
+      if (speed_x[i] > EPSILON) {
+        speed_x[i] = 0;
+        speed_y[i] = 0;
+      }
+      continue;
+    }
+
+    double new_x = this->next_x_[i];
+    double new_y = this->next_y_[i];
+
+    if (radius[i] != 0) {
+      // Collision check against the neighbouring cells only, static geometry
+      // first
+      auto &world_object = this->world_objects_[i];
+      std::shared_ptr<WorldObject> other =
+          static_geometry.FindOverlap(new_x, new_y, radius[i]);
+      if (!other) {
+        uint32_t j = this->grid_.FindOverlap(
+            new_x, new_y, radius[i], [&](uint32_t j) {
+              return j != i && !(flags[j] & PHYSICS_DESTROYED);
+            });
+        if (j != SpatialGrid::NO_ITEM) {
+          other = this->world_objects_[j];
         }
       }
 
-      // Skip additional frames if the system is lagging
-      while (elapsedTime >= frameDuration) {
-        lastTime += frameDuration;
-        elapsedTime -= frameDuration;
+      if (other) {
+        // Collision detected!
+        other->HandleCollision(world_object);
+        world_object->HandleCollision(other);
       }
     }
 
-    // Sleep to prevent busy-waiting (ensure loop doesn't consume 100% CPU)
-    std::this_thread::sleep_for(milliseconds(1));
+    // Update position
+    position_x[i] = new_x;
+    position_y[i] = new_y;
+    position_z[i] = this->next_z_[i];
+  }
+
+  // Objects destroyed during the frame, or since the last one, can no longer
+  // be looked up
+  for (uint32_t i = 0; i < count; i++) {
+    if ((flags[i] & PHYSICS_DESTROYED) && this->dense_slots_[i] != NO_SLOT) {
+      this->ReleaseSlot(i);
+    }
   }
 }
+
 std::shared_ptr<WorldObject> World::GetWorldObjectById(uint64_t id) {
-  for (auto &wo : this->world_objects_) {
-    if (wo->GetId() == id) {
-      return wo;
-    }
+  std::lock_guard<std::mutex> lock(wo_m);
+  uint32_t slot = this->id_index_.Find(id);
+  if (slot != ObjectIndex::NOT_FOUND) {
+    return this->world_objects_[this->slots_[slot].dense_];
+  }
+  auto static_geometry = this->GetStaticGeometry();
+  return static_geometry ? static_geometry->FindById(id) : nullptr;
+}
+
+std::shared_ptr<WorldObject> World::GetWorldObject(ObjectHandle handle) {
+  std::lock_guard<std::mutex> lock(wo_m);
+  if (handle.IsNull() || handle.slot_ >= this->slots_.size() ||
+      this->slots_[handle.slot_].generation_ != handle.generation_) {
+    return nullptr;
   }
-  return nullptr;
+  return this->world_objects_[this->slots_[handle.slot_].dense_];
 }
 
 void World::GenerateRandomWalls(int num_walls, int wall_radius) {
@@ -154,8 +508,7 @@ void World::GenerateRandomWalls(int num_walls, int wall_radius) {
 
     // Create a new wall and set its properties
     auto wall = std::make_shared<Wall>();
-    wall->GetPosition().SetX(x);
-    wall->GetPosition().SetY(y);
+    wall->SetPosition(Vector3(x, y, 0));
     wall->SetRadius(wall_radius); // Set radius for visualization
 
     // Add the wall to the world
@@ -179,8 +532,7 @@ void World::GenerateRandomBoosts(int num_boosts) {
     double y = y_dist(rng);
 
     auto boost = std::make_shared<Boost>();
-    boost->GetPosition().SetX(x);
-    boost->GetPosition().SetY(y);
+    boost->SetPosition(Vector3(x, y, 0));
     boost->SetRadius(1); // Set radius for visualization
 
     AddObject(boost);
@@ -191,30 +543,26 @@ void World::GenWallBounds() {
   for (size_t x = 0; x < this->world_settings_.sizeX_; x++) {
 
     auto wall = std::make_shared<Wall>();
-    wall->GetPosition().SetX(x);
-    wall->GetPosition().SetY(1);
+    wall->SetPosition(Vector3(x, 1, 0));
     wall->SetRadius(1);
 
     AddObject(wall);
 
     wall = std::make_shared<Wall>();
-    wall->GetPosition().SetX(x);
-    wall->GetPosition().SetY(this->world_settings_.sizeY_ - 1);
+    wall->SetPosition(Vector3(x, this->world_settings_.sizeY_ - 1, 0));
     wall->SetRadius(1);
 
     AddObject(wall);
   }
   for (size_t y = 0; y < this->world_settings_.sizeY_; y++) {
     auto wall = std::make_shared<Wall>();
-    wall->GetPosition().SetX(1);
-    wall->GetPosition().SetY(y);
+    wall->SetPosition(Vector3(1, y, 0));
     wall->SetRadius(1);
 
     AddObject(wall);
 
     wall = std::make_shared<Wall>();
-    wall->GetPosition().SetX(this->world_settings_.sizeX_ - 1);
-    wall->GetPosition().SetY(y);
+    wall->SetPosition(Vector3(this->world_settings_.sizeX_ - 1, y, 0));
     wall->SetRadius(1);
 
     AddObject(wall);
@@ -1,4 +1,5 @@
 #include "world/world_object.hpp"
+#include "world/physics_store.hpp"
 #include <cstdint>
 #include <random>
 
@@ -9,4 +10,69 @@ std::uniform_int_distribution<std::mt19937::result_type>
 namespace World {
 WorldObject::WorldObject() { this->id_ = random_distr(rng); }
 void WorldObject::HandleCollision(std::shared_ptr<WorldObject> other) {}
+
+Vector3 WorldObject::GetPosition() {
+  return store_ ? store_->GetPosition(handle_) : position_;
+}
+
+void WorldObject::SetPosition(const Vector3 &position) {
+  if (store_) {
+    store_->SetPosition(handle_, position);
+  } else {
+    position_ = position;
+  }
+}
+
+Vector3 WorldObject::GetSpeed() {
+  return store_ ? store_->GetSpeed(handle_) : speed_;
+}
+
+void WorldObject::SetSpeed(const Vector3 &speed) {
+  if (store_) {
+    store_->SetSpeed(handle_, speed);
+  } else {
+    speed_ = speed;
+  }
+}
+
+uint64_t WorldObject::GetRadius() {
+  return store_ ? (uint64_t)store_->GetRadius(handle_) : radius_;
+}
+
+void WorldObject::SetRadius(uint64_t radius) {
+  if (store_) {
+    store_->SetRadius(handle_, radius);
+  } else {
+    radius_ = radius;
+  }
+}
+
+bool WorldObject::IsDestroyed() {
+  return store_ ? store_->HasFlag(handle_, PHYSICS_DESTROYED) : destroyed_;
+}
+
+void WorldObject::SetIsDestroyed(bool destroyed) {
+  if (store_) {
+    store_->SetFlag(handle_, PHYSICS_DESTROYED, destroyed);
+  } else {
+    destroyed_ = destroyed;
+  }
+}
+
+void WorldObject::Attach(PhysicsStore *store, PhysicsHandle handle) {
+  this->store_ = store;
+  this->handle_ = handle;
+}
+
+void WorldObject::Detach() {
+  if (!store_) {
+    return;
+  }
+  position_ = store_->GetPosition(handle_);
+  speed_ = store_->GetSpeed(handle_);
+  radius_ = (uint64_t)store_->GetRadius(handle_);
+  destroyed_ = store_->HasFlag(handle_, PHYSICS_DESTROYED);
+  store_ = nullptr;
+  handle_ = 0;
+}
 } // namespace World
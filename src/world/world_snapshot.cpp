@@ -0,0 +1,32 @@
+#include "world/world_snapshot.hpp"
+#include <cstdint>
+#include <optional>
+
+namespace World {
+std::optional<RayHit> WorldSnapshot::RayCast(const Vector3 &origin,
+                                             const Vector3 &direction,
+                                             double max_distance,
+                                             uint64_t ignore_id) const {
+  double x = origin.GetX(), y = origin.GetY();
+  double dir_x = direction.GetX(), dir_y = direction.GetY();
+  double distance = max_distance;
+  const ObjectState *hit = nullptr;
+
+  // The static hit bounds the dynamic search
+  if (this->static_geometry_) {
+    hit = this->static_geometry_->RayCast(x, y, dir_x, dir_y, distance);
+  }
+  uint32_t index =
+      this->grid_.RayCast(x, y, dir_x, dir_y, distance, [&](uint32_t i) {
+        return this->objects_[i].id_ != ignore_id;
+      });
+  if (index != SpatialGrid::NO_ITEM) {
+    hit = &this->objects_[index];
+  }
+
+  if (!hit) {
+    return std::nullopt;
+  }
+  return RayHit{*hit, distance};
+}
+} // namespace World
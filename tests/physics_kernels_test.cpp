@@ -0,0 +1,149 @@
+#include "world/physics_kernels.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Checks that every vector kernel the running CPU supports gives
+// bit-identical results to the scalar ones, on random inputs of every tail
+// length
+
+namespace {
+
+constexpr double kSizeX = 1000;
+constexpr double kSizeY = 800;
+
+std::mt19937_64 rng(42);
+
+double Uniform(double min, double max) {
+  return std::uniform_real_distribution<double>(min, max)(rng);
+}
+
+std::vector<double> RandomArray(size_t count, double min, double max) {
+  std::vector<double> values(count);
+  for (auto &value : values) {
+    value = Uniform(min, max);
+  }
+  return values;
+}
+
+bool SameBits(const std::vector<double> &a, const std::vector<double> &b) {
+  return std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+int CheckIntegrate(const World::PhysicsKernels &kernels,
+                   const World::PhysicsKernels &scalar, size_t count) {
+  // Positions around the map, so that some objects leave it
+  auto position_x = RandomArray(count, -10, kSizeX + 10);
+  auto position_y = RandomArray(count, -10, kSizeY + 10);
+  auto position_z = RandomArray(count, -1, 1);
+  auto speed_x = RandomArray(count, -50, 50);
+  auto speed_y = RandomArray(count, -50, 50);
+  auto speed_z = RandomArray(count, -1, 1);
+  // Some objects right on the edges
+  for (size_t i = 0; i < count; i += 7) {
+    position_x[i] = (i % 2) ? kSizeX : 0;
+    speed_x[i] = 0;
+  }
+  double delta_time = Uniform(0.001, 0.1);
+
+  std::vector<double> next_x(count), next_y(count), next_z(count);
+  std::vector<double> expected_x(count), expected_y(count),
+      expected_z(count);
+  std::vector<uint8_t> out_of_bounds(count), expected_out_of_bounds(count);
+
+  kernels.integrate(count, position_x.data(), position_y.data(),
+                    position_z.data(), speed_x.data(), speed_y.data(),
+                    speed_z.data(), delta_time, kSizeX, kSizeY,
+                    next_x.data(), next_y.data(), next_z.data(),
+                    out_of_bounds.data());
+  scalar.integrate(count, position_x.data(), position_y.data(),
+                   position_z.data(), speed_x.data(), speed_y.data(),
+                   speed_z.data(), delta_time, kSizeX, kSizeY,
+                   expected_x.data(), expected_y.data(), expected_z.data(),
+                   expected_out_of_bounds.data());
+
+  if (!SameBits(next_x, expected_x) || !SameBits(next_y, expected_y) ||
+      !SameBits(next_z, expected_z)) {
+    std::printf("%s integrate: positions differ for %zu objects\n",
+                kernels.name, count);
+    return 1;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (out_of_bounds[i] != expected_out_of_bounds[i]) {
+      std::printf("%s integrate: out of bounds flag %zu of %zu differs\n",
+                  kernels.name, i, count);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int CheckFirstOverlap(const World::PhysicsKernels &kernels,
+                      const World::PhysicsKernels &scalar, size_t count) {
+  // Sparse circles, so that the first overlap falls anywhere, or nowhere
+  auto xs = RandomArray(count, 0, kSizeX);
+  auto ys = RandomArray(count, 0, kSizeY);
+  auto radii = RandomArray(count, 0, 20);
+  for (size_t i = 0; i < count; i += 5) {
+    radii[i] = 0;
+  }
+  double x = Uniform(0, kSizeX);
+  double y = Uniform(0, kSizeY);
+  double radius = Uniform(0, 20);
+  if (count > 0 && Uniform(0, 1) < 0.5) {
+    // A circle exactly touching one of them
+    size_t k = std::uniform_int_distribution<size_t>(0, count - 1)(rng);
+    x = xs[k] + radii[k] + radius;
+    y = ys[k];
+  }
+
+  size_t first = kernels.first_overlap(x, y, radius, xs.data(), ys.data(),
+                                       radii.data(), count);
+  size_t expected = scalar.first_overlap(x, y, radius, xs.data(), ys.data(),
+                                         radii.data(), count);
+  if (first != expected) {
+    std::printf("%s first_overlap: %zu instead of %zu of %zu circles\n",
+                kernels.name, first, expected, count);
+    return 1;
+  }
+  return 0;
+}
+
+int CheckKernels(const World::PhysicsKernels &kernels,
+                 const World::PhysicsKernels &scalar) {
+  int failures = 0;
+  for (int round = 0; round < 200; round++) {
+    // Every remainder of the vector widths, and longer arrays
+    for (size_t count = 0; count <= 67; count++) {
+      failures += CheckIntegrate(kernels, scalar, count);
+      failures += CheckFirstOverlap(kernels, scalar, count);
+    }
+    size_t count = std::uniform_int_distribution<size_t>(68, 4096)(rng);
+    failures += CheckIntegrate(kernels, scalar, count);
+    failures += CheckFirstOverlap(kernels, scalar, count);
+  }
+  std::printf("%s kernels checked against scalar, %d failures\n",
+              kernels.name, failures);
+  return failures;
+}
+
+} // namespace
+
+int main() {
+  const World::PhysicsKernels &scalar = World::GetScalarPhysicsKernels();
+  const World::PhysicsKernels *vector_kernels[] = {
+      World::GetSSE2PhysicsKernels(), World::GetAVX2PhysicsKernels()};
+
+  int failures = 0;
+  for (const World::PhysicsKernels *kernels : vector_kernels) {
+    // Not supported by the running CPU
+    if (!kernels) {
+      continue;
+    }
+    failures += CheckKernels(*kernels, scalar);
+  }
+  return failures == 0 ? 0 : 1;
+}
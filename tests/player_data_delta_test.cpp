@@ -0,0 +1,109 @@
+#include "battle_c.pb.h"
+#include "executor/player_data_delta.hpp"
+#include "server/latest_slot.hpp"
+#include <cstdio>
+
+// Checks that the player data deltas published to a peer's slot never lose
+// a change, even when the writer skips some of them
+
+using battle_c::PlayerData;
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool condition, const char *what) {
+  if (!condition) {
+    std::printf("failed: %s\n", what);
+    failures++;
+  }
+}
+
+PlayerData State(float x, int health, int score) {
+  PlayerData pd;
+  pd.set_id(1);
+  pd.mutable_position()->set_x(x);
+  pd.mutable_speed()->set_x(1);
+  pd.set_health(health);
+  pd.set_armor(0);
+  pd.set_score(score);
+  pd.set_alive(true);
+  return pd;
+}
+
+/**
+ * Strip the state and publish it like the executor does.
+ * Returns false if nothing was published
+ */
+bool Send(PlayerDataDelta &delta, LatestSlot<PlayerData> &slot,
+          PlayerData pd) {
+  if (!delta.Strip(pd, slot.Pending())) {
+    return false;
+  }
+  slot.Back() = pd;
+  slot.Publish();
+  return true;
+}
+
+void TestReplacedDelta() {
+  PlayerDataDelta delta;
+  LatestSlot<PlayerData> slot;
+
+  Send(delta, slot, State(0, 100, 0));
+  PlayerData *taken = slot.Take();
+  Expect(taken && taken->keyframe(), "the first update is a keyframe");
+
+  // Two deltas before the writer takes one, the first is replaced
+  Send(delta, slot, State(0, 50, 0));
+  Send(delta, slot, State(10, 50, 0));
+  taken = slot.Take();
+  Expect(taken && !taken->keyframe(), "the replacing update is a delta");
+  Expect(taken && taken->has_health() && taken->health() == 50,
+         "the replacing delta repeats the replaced change");
+  Expect(taken && taken->has_position() && taken->position().x() == 10,
+         "the replacing delta holds its own change");
+  Expect(taken && !taken->has_speed() && !taken->has_score(),
+         "the replacing delta holds no unchanged field");
+
+  // Once taken, the next delta only holds its own change
+  Send(delta, slot, State(10, 50, 20));
+  taken = slot.Take();
+  Expect(taken && taken->has_score() && !taken->has_health() &&
+             !taken->has_position(),
+         "a delta after a taken one holds only its change");
+}
+
+void TestUnchangedWhilePending() {
+  PlayerDataDelta delta;
+  LatestSlot<PlayerData> slot;
+
+  Send(delta, slot, State(0, 100, 0));
+  slot.Take();
+  Send(delta, slot, State(0, 70, 0));
+  Expect(!Send(delta, slot, State(0, 70, 0)),
+         "nothing is published without a change");
+  PlayerData *taken = slot.Take();
+  Expect(taken && taken->has_health() && taken->health() == 70,
+         "the pending delta is kept");
+}
+
+void TestReplacedKeyframe() {
+  PlayerDataDelta delta;
+  LatestSlot<PlayerData> slot;
+
+  Send(delta, slot, State(0, 100, 0));
+  Send(delta, slot, State(5, 100, 0));
+  PlayerData *taken = slot.Take();
+  Expect(taken && taken->keyframe() && taken->has_health(),
+         "an update replacing a keyframe is a keyframe");
+}
+
+} // namespace
+
+int main() {
+  TestReplacedDelta();
+  TestUnchangedWhilePending();
+  TestReplacedKeyframe();
+  std::printf("player data deltas checked, %d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
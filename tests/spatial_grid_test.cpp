@@ -0,0 +1,76 @@
+#include "world/spatial_grid.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+
+// Checks when the grid reports two circles as overlapping, and that queries
+// of any extent stay within the grid
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool condition, const char *what) {
+  if (!condition) {
+    std::printf("failed: %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * Whether a circle at (x, 100) overlaps the one inserted at (100, 100)
+ */
+bool Overlaps(double x, double radius, double inserted_radius = 10) {
+  World::SpatialGrid grid;
+  grid.Reset(1000, 1000, 50);
+  grid.Insert(0, 100, 100, inserted_radius);
+  grid.Build();
+  return grid.FindOverlap(x, 100, radius, [](uint32_t) { return true; }) !=
+         World::SpatialGrid::NO_ITEM;
+}
+
+void TestOverlap() {
+  // Distances are compared exactly, they used to be truncated to whole
+  // units, so 20.5 < 20.2 was a collision
+  Expect(Overlaps(120.1, 10.2), "closer than the radii overlaps");
+  Expect(!Overlaps(120.5, 10.2), "farther than the radii doesn't overlap");
+  Expect(!Overlaps(120.9, 10.5), "a fraction farther doesn't overlap");
+  Expect(!Overlaps(120, 10), "touching circles don't overlap");
+  Expect(!Overlaps(100, 10, 0), "a circle of radius 0 doesn't overlap");
+}
+
+void TestHugeRange() {
+  World::SpatialGrid grid;
+  grid.Reset(1000, 1000, 50);
+  for (uint32_t i = 0; i < 100; i++) {
+    grid.Insert(i, (i % 10) * 100 + 5, (i / 10) * 100 + 5, 1);
+  }
+  grid.Build();
+
+  const double ranges[] = {1e12, 1e300,
+                           std::numeric_limits<double>::infinity()};
+  for (double range : ranges) {
+    uint32_t visited = 0;
+    grid.ForEachNear(500, 500, range, [&](uint32_t) {
+      visited++;
+      return false;
+    });
+    Expect(visited == 100, "a range past the bounds visits every item");
+
+    visited = 0;
+    grid.ForEachNear(-range, -range, 1, [&](uint32_t) {
+      visited++;
+      return false;
+    });
+    Expect(visited == 1, "a position far out lands in a border cell");
+  }
+}
+
+} // namespace
+
+int main() {
+  TestOverlap();
+  TestHugeRange();
+  std::printf("spatial grid checked, %d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}